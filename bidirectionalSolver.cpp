@@ -0,0 +1,210 @@
+#include "bidirectionalSolver.hpp"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <iomanip>
+#include <iostream>
+
+// Longest any cube needs, so the search never has to go further than this
+static const int GODS_NUMBER = 20;
+
+// A move is skipped if it turns the same face as the previous move or if it turns the
+// opposite face in the wrong order, since opposite faces commute.
+static bool redundantMove(int face, int previousFace)
+{
+    return face == previousFace || (face / 2 == previousFace / 2 && face < previousFace);
+}
+
+BidirectionalSolver::BidirectionalSolver(const EndgameTable &_table, size_t _maxStates)
+: table(_table), maxStates(_maxStates)
+{}
+
+/**
+ * @brief Adds the hash of a canonical cube to the visited set, growing it to keep it at most half full.
+ *
+ * @return true if the hash was not in the set yet
+ */
+bool BidirectionalSolver::visit(uint64_t hash)
+{
+    // 0 marks an empty slot
+    hash = hash ? hash : 1;
+    if ((nodes.size() + 1) * 2 > visited.size())
+    {
+        std::vector<uint64_t> old(visited.size() * 2, 0);
+        old.swap(visited);
+        for (uint64_t slot : old)
+        {
+            if (slot == 0)
+                continue;
+            size_t i = slot & (visited.size() - 1);
+            while (visited[i] != 0)
+                i = (i + 1) & (visited.size() - 1);
+            visited[i] = slot;
+        }
+    }
+
+    size_t mask = visited.size() - 1;
+    size_t i = hash & mask;
+    for (; visited[i] != 0; i = (i + 1) & mask)
+    {
+        if (visited[i] == hash)
+            return false;
+    }
+    visited[i] = hash;
+    return true;
+}
+
+size_t BidirectionalSolver::bytes() const
+{
+    return nodes.capacity() * sizeof(Node) + visited.capacity() * sizeof(uint64_t) + (frontier.capacity() + next.capacity()) * sizeof(RubixCube);
+}
+
+// The table is only asked for a solution of a cube that looks like it is in it, since the table checks its
+// solutions and so also rejects cubes that only share part of their hash with a cube in the table
+bool BidirectionalSolver::meets(const RubixCube &cube, const RubixCube &canonical)
+{
+    return table.distance(canonical) >= 0 && table.solve(cube, meeting);
+}
+
+/**
+ * @brief Depth first search of every sequence of depth moves from a cube, stopping at the first cube in the table.
+ *
+ * @param path Moves from the frontier cube, the moves of the cube found are left in it
+ */
+bool BidirectionalSolver::search(const RubixCube &cube, int depth, int previousFace, MoveSequence &path, size_t &checked)
+{
+    if (depth == 0)
+    {
+        checked++;
+        return meets(cube, cube.canonical());
+    }
+
+    for (int move = 0; move < 18; move++)
+    {
+        if (redundantMove(move / 3, previousFace))
+            continue;
+
+        RubixCube moved = cube;
+        moved.applyMove(move);
+        path.push_back(Move(move));
+        if (search(moved, depth - 1, move / 3, path, checked))
+            return true;
+        path.pop_back();
+    }
+    return false;
+}
+
+/**
+ * @brief Expands the forward search one depth at a time until it reaches a cube in the table. Every depth before
+ * that was checked without reaching the table, so the cube is exactly the table's depth from solved and no other
+ * cube can give a shorter solution. Depths are searched breadth first, keeping every state, while the next depth
+ * fits in maxStates, and then depth first from the cubes of the last depth kept, which needs no more memory.
+ *
+ * @param cube The cube to solve, it must be a valid cube
+ * @return true if solution was set
+ */
+bool BidirectionalSolver::solve(const RubixCube &cube, MoveSequence &solution)
+{
+    auto startTime = std::chrono::steady_clock::now();
+    solution.clear();
+    nodes.clear();
+    visited.assign(1024, 0);
+    frontier.assign(1, cube);
+    frontiers.clear();
+
+    RubixCube canonical = cube.canonical();
+    if (table.distance(canonical) >= 0)
+        return table.solve(cube, solution);
+
+    auto record = [&](int depth, size_t states)
+    {
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = now - startTime;
+        frontiers.push_back({depth, states, bytes(), elapsed.count()});
+        startTime = now;
+    };
+
+    // The moves from the cube to a node, then path, then the moves the table found from there to solved
+    auto finish = [&](size_t node, const MoveSequence &path)
+    {
+        for (; node != 0; node = nodes[node].parent)
+            solution.push_back(Move(nodes[node].move));
+        std::reverse(&solution[0], &solution[0] + solution.size());
+        for (Move move : path)
+            solution.push_back(move);
+        for (Move move : meeting)
+            solution.push_back(move);
+    };
+
+    nodes.push_back({0, 0});
+    visit(canonical.hash());
+    record(0, 1);
+    int depth = 1;
+
+    // No node has more than 15 moves that aren't redundant
+    for (; depth + table.depth() <= GODS_NUMBER && nodes.size() + frontier.size() * 15 <= maxStates; depth++)
+    {
+        size_t first = nodes.size() - frontier.size();
+        next.clear();
+
+        for (size_t i = 0; i < frontier.size(); i++)
+        {
+            int previousFace = first + i == 0 ? -1 : nodes[first + i].move / 3;
+            for (int move = 0; move < 18; move++)
+            {
+                if (redundantMove(move / 3, previousFace))
+                    continue;
+
+                RubixCube moved = frontier[i];
+                moved.applyMove(move);
+                canonical = moved.canonical();
+                if (!visit(canonical.hash()))
+                    continue;
+
+                nodes.push_back({static_cast<uint32_t>(first + i), static_cast<uint8_t>(move)});
+                next.push_back(moved);
+                if (meets(moved, canonical))
+                {
+                    frontier.swap(next);
+                    record(depth, frontier.size());
+                    finish(nodes.size() - 1, MoveSequence());
+                    return true;
+                }
+            }
+        }
+
+        frontier.swap(next);
+        record(depth, frontier.size());
+    }
+
+    MoveSequence path;
+    size_t first = nodes.size() - frontier.size();
+    for (int extra = 1; depth + table.depth() <= GODS_NUMBER; depth++, extra++)
+    {
+        size_t checked = 0;
+        for (size_t i = 0; i < frontier.size(); i++)
+        {
+            int previousFace = first + i == 0 ? -1 : nodes[first + i].move / 3;
+            if (search(frontier[i], extra, previousFace, path, checked))
+            {
+                record(depth, checked);
+                finish(first + i, path);
+                return true;
+            }
+        }
+        record(depth, checked);
+    }
+
+    return false;
+}
+
+void BidirectionalSolver::printStats() const
+{
+    std::cout << "Depth" << std::setw(12) << "States" << std::setw(12) << "MB" << std::setw(12) << "Seconds" << std::endl;
+    for (const FrontierStats &depth : frontiers)
+        std::cout << std::setw(5) << depth.depth << std::setw(12) << depth.states << std::setw(12) << std::fixed << std::setprecision(1) << depth.bytes / 1000000.0
+            << std::setw(12) << std::setprecision(3) << depth.seconds << std::endl;
+
+    std::cout << "Searched " << nodes.size() << " states with at most " << peakBytes() / 1000000.0 << " MB, plus "
+        << table.bytes() / 1000000.0 << " MB for the table of cubes within " << table.depth() << " moves." << std::endl;
+}
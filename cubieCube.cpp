@@ -0,0 +1,319 @@
+#include "cubieCube.hpp"
+#include <cstring>
+
+// #######################
+// Facelet Layout
+// #######################
+
+const uint8_t cornerFacelets[8][3] =
+{
+    {UP * 9 + 8, RIGHT * 9 + 0, FRONT * 9 + 2}, // URF
+    {UP * 9 + 6, FRONT * 9 + 0, LEFT * 9 + 2}, // UFL
+    {UP * 9 + 0, LEFT * 9 + 0, BACK * 9 + 2}, // ULB
+    {UP * 9 + 2, BACK * 9 + 0, RIGHT * 9 + 2}, // UBR
+    {DOWN * 9 + 2, FRONT * 9 + 8, RIGHT * 9 + 6}, // DFR
+    {DOWN * 9 + 0, LEFT * 9 + 8, FRONT * 9 + 6}, // DLF
+    {DOWN * 9 + 6, BACK * 9 + 8, LEFT * 9 + 6}, // DBL
+    {DOWN * 9 + 8, RIGHT * 9 + 8, BACK * 9 + 6} // DRB
+};
+
+const uint8_t edgeFacelets[12][2] =
+{
+    {UP * 9 + 5, RIGHT * 9 + 1}, // UR
+    {UP * 9 + 7, FRONT * 9 + 1}, // UF
+    {UP * 9 + 3, LEFT * 9 + 1}, // UL
+    {UP * 9 + 1, BACK * 9 + 1}, // UB
+    {DOWN * 9 + 5, RIGHT * 9 + 7}, // DR
+    {DOWN * 9 + 1, FRONT * 9 + 7}, // DF
+    {DOWN * 9 + 3, LEFT * 9 + 7}, // DL
+    {DOWN * 9 + 7, BACK * 9 + 7}, // DB
+    {FRONT * 9 + 5, RIGHT * 9 + 3}, // FR
+    {FRONT * 9 + 3, LEFT * 9 + 5}, // FL
+    {BACK * 9 + 5, LEFT * 9 + 3}, // BL
+    {BACK * 9 + 3, RIGHT * 9 + 5} // BR
+};
+
+// The color of a sticker on a solved cube is the face it is on
+static RubixColor faceletColor(int facelet)
+{
+    return static_cast<RubixColor>(facelet / 9);
+}
+
+// #######################
+// CubieCube Class
+// #######################
+
+/**
+ * @brief The cubie version of each of the 18 moves, found by converting a solved RubixCube
+ * with that move applied so both models always agree on what a move does.
+ */
+static const CubieCube * moveCubes()
+{
+    static const std::vector<CubieCube> cubes = []()
+    {
+        std::vector<CubieCube> moves;
+        for (int move = 0; move < 18; move++)
+            moves.emplace_back(RubixCube().applyMove(move));
+        return moves;
+    }();
+
+    return cubes.data();
+}
+
+CubieCube::CubieCube()
+{
+    for (int i = 0; i < 8; i++)
+        corners[i] = i;
+    for (int i = 0; i < 12; i++)
+        edges[i] = i;
+}
+
+// Piece and twist (or flip) of every combination of sticker colors, read in the order of cornerFacelets
+// and edgeFacelets with the colors as digits in base 6. Combinations that are not a real piece are invalid.
+struct PieceTables
+{
+    uint8_t corners[6 * 6 * 6];
+    uint8_t edges[6 * 6];
+};
+
+static const PieceTables & pieceTables()
+{
+    static const PieceTables tables = []()
+    {
+        PieceTables t;
+        std::memset(&t, CubieCube::INVALID_PIECE, sizeof(t));
+
+        for (int j = 0; j < 8; j++)
+        {
+            for (int twist = 0; twist < 3; twist++)
+            {
+                // A piece twisted by twist has its U/D sticker at index twist
+                int colors[3];
+                for (int k = 0; k < 3; k++)
+                    colors[(k + twist) % 3] = faceletColor(cornerFacelets[j][k]);
+                t.corners[(colors[0] * 6 + colors[1]) * 6 + colors[2]] = j | twist << 3;
+            }
+        }
+
+        for (int j = 0; j < 12; j++)
+        {
+            for (int flip = 0; flip < 2; flip++)
+                t.edges[faceletColor(edgeFacelets[j][flip]) * 6 + faceletColor(edgeFacelets[j][1 - flip])] = j | flip << 4;
+        }
+
+        return t;
+    }();
+
+    return tables;
+}
+
+/**
+ * @brief Identifies every piece of a sticker cube from its colors with one table lookup per piece.
+ * Positions whose stickers do not belong to any real piece are set to INVALID_PIECE.
+ *
+ * @param cube The cube to convert, its colors must be valid RubixColor values
+ */
+CubieCube::CubieCube(const RubixCube &cube)
+{
+    const PieceTables &t = pieceTables();
+
+    for (int i = 0; i < 8; i++)
+    {
+        const uint8_t *facelets = cornerFacelets[i];
+        corners[i] = t.corners[(cube.stickers[facelets[0]] * 6 + cube.stickers[facelets[1]]) * 6 + cube.stickers[facelets[2]]];
+    }
+
+    for (int i = 0; i < 12; i++)
+        edges[i] = t.edges[cube.stickers[edgeFacelets[i][0]] * 6 + cube.stickers[edgeFacelets[i][1]]];
+}
+
+RubixCube CubieCube::toRubixCube() const
+{
+    RubixCube cube; // Centers never move so start from a solved cube
+
+    for (int i = 0; i < 8; i++)
+    {
+        for (int k = 0; k < 3; k++)
+            cube.stickers[cornerFacelets[i][(k + cornerTwist(i)) % 3]] = faceletColor(cornerFacelets[cornerPiece(i)][k]);
+    }
+
+    for (int i = 0; i < 12; i++)
+    {
+        for (int k = 0; k < 2; k++)
+            cube.stickers[edgeFacelets[i][(k + edgeFlip(i)) % 2]] = faceletColor(edgeFacelets[edgePiece(i)][k]);
+    }
+
+    return cube;
+}
+
+CubieCube & CubieCube::applyMove(int move)
+{
+    return multiply(moveCubes()[move]);
+}
+
+/**
+ * @brief Applies the piece movement of another cube on top of this one.
+ * Applying a move is multiplying by the cube that move makes from a solved cube.
+ *
+ * @param other The cube whose permutation is applied after this one
+ * @return CubieCube&
+ */
+CubieCube & CubieCube::multiply(const CubieCube &other)
+{
+    uint8_t product[8];
+    for (int i = 0; i < 8; i++)
+    {
+        uint8_t piece = corners[other.cornerPiece(i)];
+        product[i] = (piece & 7) | (((piece >> 3) + other.cornerTwist(i)) % 3) << 3;
+    }
+    std::memcpy(corners, product, sizeof(corners));
+
+    uint8_t edgeProduct[12];
+    for (int i = 0; i < 12; i++)
+        edgeProduct[i] = edges[other.edgePiece(i)] ^ (other.edgeFlip(i) << 4);
+    std::memcpy(edges, edgeProduct, sizeof(edges));
+
+    return *this;
+}
+
+/**
+ * @brief Locates a corner piece without searching the stickers
+ *
+ * @return int The position the piece is in, -1 if it is missing
+ */
+int CubieCube::findCorner(CornerCubie corner) const
+{
+    for (int i = 0; i < 8; i++)
+    {
+        if (cornerPiece(i) == corner)
+            return i;
+    }
+
+    return -1;
+}
+
+int CubieCube::findEdge(EdgeCubie edge) const
+{
+    for (int i = 0; i < 12; i++)
+    {
+        if (edgePiece(i) == edge)
+            return i;
+    }
+
+    return -1;
+}
+
+bool CubieCube::operator==(const CubieCube &other) const
+{
+    return std::memcmp(corners, other.corners, sizeof(corners)) == 0 && std::memcmp(edges, other.edges, sizeof(edges)) == 0;
+}
+
+// #######################
+// Validation
+// #######################
+
+std::string CubeValidation::reason() const
+{
+    std::string where = std::to_string(position);
+    switch (validity)
+    {
+        case VALID_CUBE:
+            return "valid cube";
+        case WRONG_COLOR_COUNT:
+            return "color " + where + " is not on exactly 9 stickers";
+        case WRONG_CENTER:
+            return "the center of face " + where + " is the wrong color";
+        case INVALID_CORNER:
+            return "the stickers of corner position " + where + " are not a corner piece";
+        case INVALID_EDGE:
+            return "the stickers of edge position " + where + " are not an edge piece";
+        case DUPLICATE_CORNER:
+            return "the corner in position " + where + " is also in another position";
+        case DUPLICATE_EDGE:
+            return "the edge in position " + where + " is also in another position";
+        case TWISTED_CORNER:
+            return "a corner is twisted";
+        case FLIPPED_EDGE:
+            return "an edge is flipped";
+        case PERMUTATION_PARITY:
+            return "two pieces are swapped";
+        default:
+            return "unknown validity";
+    }
+}
+
+// Parity of the number of swaps that sort a permutation, 1 if odd
+template <int N>
+static int permutationParity(const uint8_t *pieces, uint8_t mask)
+{
+    int parity = 0;
+    for (int i = 0; i < N; i++)
+    {
+        for (int j = i + 1; j < N; j++)
+            parity ^= (pieces[i] & mask) > (pieces[j] & mask);
+    }
+    return parity;
+}
+
+/**
+ * @brief Checks everything a cube needs to be solvable, from the sticker colors up to the
+ * parity of the pieces. The checks run in that order so the reason given is the most basic problem.
+ *
+ * @param cube The cube to check
+ * @return CubeValidation VALID_CUBE, or the first problem found and where it is
+ */
+CubeValidation CubieCube::validate(const RubixCube &cube)
+{
+    int counts[6] = {};
+    for (int i = 0; i < 54; i++)
+    {
+        if (cube.stickers[i] > GREEN)
+            return {WRONG_COLOR_COUNT, cube.stickers[i]};
+        counts[cube.stickers[i]]++;
+    }
+    for (int color = 0; color < 6; color++)
+    {
+        if (counts[color] != 9)
+            return {WRONG_COLOR_COUNT, color};
+    }
+    for (int face = 0; face < 6; face++)
+    {
+        if (cube.stickers[face * 9 + 4] != face)
+            return {WRONG_CENTER, face};
+    }
+
+    CubieCube cubie(cube);
+    unsigned seen = 0;
+    int twist = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        if (cubie.corners[i] == INVALID_PIECE)
+            return {INVALID_CORNER, i};
+        if (seen & 1 << cubie.cornerPiece(i))
+            return {DUPLICATE_CORNER, i};
+        seen |= 1 << cubie.cornerPiece(i);
+        twist += cubie.cornerTwist(i);
+    }
+
+    seen = 0;
+    int flip = 0;
+    for (int i = 0; i < 12; i++)
+    {
+        if (cubie.edges[i] == INVALID_PIECE)
+            return {INVALID_EDGE, i};
+        if (seen & 1 << cubie.edgePiece(i))
+            return {DUPLICATE_EDGE, i};
+        seen |= 1 << cubie.edgePiece(i);
+        flip += cubie.edgeFlip(i);
+    }
+
+    if (twist % 3 != 0)
+        return {TWISTED_CORNER, -1};
+    if (flip % 2 != 0)
+        return {FLIPPED_EDGE, -1};
+    // Every quarter turn swaps corners and edges an odd number of times each, so the two parities always match
+    if (permutationParity<8>(cubie.corners, 7) != permutationParity<12>(cubie.edges, 15))
+        return {PERMUTATION_PARITY, -1};
+
+    return {VALID_CUBE, -1};
+}
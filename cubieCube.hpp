@@ -0,0 +1,100 @@
+#pragma once
+#include "rubixCube.hpp"
+
+// Corner and edge positions of the cube, also used to name the piece that belongs in each position.
+enum CornerCubie
+{
+    URF,
+    UFL,
+    ULB,
+    UBR,
+    DFR,
+    DLF,
+    DBL,
+    DRB
+};
+
+enum EdgeCubie
+{
+    UR,
+    UF,
+    UL,
+    UB,
+    DR,
+    DF,
+    DL,
+    DB,
+    FR,
+    FL,
+    BL,
+    BR
+};
+
+// Why CubieCube::validate rejected a cube
+enum CubeValidity
+{
+    VALID_CUBE,
+    WRONG_COLOR_COUNT, // A color that is not on exactly 9 stickers
+    WRONG_CENTER, // A center that is not the color of its face
+    INVALID_CORNER, // Corner stickers whose colors don't make up any corner piece
+    INVALID_EDGE, // Edge stickers whose colors don't make up any edge piece
+    DUPLICATE_CORNER, // A corner piece that is in more than one position
+    DUPLICATE_EDGE, // An edge piece that is in more than one position
+    TWISTED_CORNER, // The corner twists don't add up to a multiple of 3
+    FLIPPED_EDGE, // An odd number of edges are flipped
+    PERMUTATION_PARITY // The corners and the edges are not both swapped an odd or both an even number of times
+};
+
+struct CubeValidation
+{
+    CubeValidity validity;
+    // The color, face, corner position or edge position at fault, -1 when the whole cube is at fault
+    int position;
+
+    bool valid() const { return validity == VALID_CUBE; }
+    std::string reason() const;
+};
+
+// Cube model that tracks the 8 corner and 12 edge pieces instead of the 54 stickers.
+// Each position holds one byte with the piece that is in it and how that piece is twisted or flipped.
+// The twist of a corner is how many CW turns its U/D sticker is away from the U/D face and the flip
+// of an edge is 1 when its U/D (or F/B for middle layer edges) sticker is not on the U/D (F/B) face.
+class CubieCube
+{
+    public:
+    CubieCube();
+    CubieCube(const RubixCube &cube);
+
+    RubixCube toRubixCube() const;
+
+    // Checks that a cube can be reached by turning the faces of a solved cube. Every solver needs this to
+    // hold and the layer by layer solver never finishes without it, so check cubes from outside sources first.
+    static CubeValidation validate(const RubixCube &cube);
+
+    // Moves use the same numbering as RubixCube
+    CubieCube & rotateCW(RubixFace face) { return applyMove(face * 3); }
+    CubieCube & rotateCCW(RubixFace face) { return applyMove(face * 3 + 2); }
+    CubieCube & rotateHalf(RubixFace face) { return applyMove(face * 3 + 1); }
+    CubieCube & applyMove(int move);
+    CubieCube & multiply(const CubieCube &other);
+
+    int cornerPiece(int position) const { return corners[position] & 7; }
+    int cornerTwist(int position) const { return corners[position] >> 3; }
+    int edgePiece(int position) const { return edges[position] & 15; }
+    int edgeFlip(int position) const { return edges[position] >> 4; }
+
+    int findCorner(CornerCubie corner) const;
+    int findEdge(EdgeCubie edge) const;
+
+    bool operator==(const CubieCube &other) const;
+
+    static const uint8_t INVALID_PIECE = 0xFF; // Stored for stickers that do not form a real piece
+
+    uint8_t corners[8]; // Piece in bits 0-2, twist in bits 3-4
+    uint8_t edges[12]; // Piece in bits 0-3, flip in bit 4
+};
+
+// Sticker indices of every corner and edge position into the RubixCube sticker array.
+// Corners are listed clockwise starting from the U/D sticker, edges start from the U/D or F/B sticker.
+extern const uint8_t cornerFacelets[8][3];
+extern const uint8_t edgeFacelets[12][2];
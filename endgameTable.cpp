@@ -0,0 +1,128 @@
+#include "endgameTable.hpp"
+#include <algorithm>
+
+// Entries keep the move + 1 in the low MOVE_BITS of their low byte and the distance in the rest of it
+static const int MOVE_BITS = 5;
+static const int ENTRY_BITS = 8;
+static const uint64_t MOVE_MASK = (1ull << MOVE_BITS) - 1;
+static const uint64_t ENTRY_MASK = (1ull << ENTRY_BITS) - 1;
+
+// The move that undoes a move, the same face turned the other way
+static int inverseMove(int move)
+{
+    return move / 3 * 3 + 2 - move % 3;
+}
+
+/**
+ * @brief Builds the table one depth at a time. Every canonical cube found at one depth is turned by each of the 18
+ * moves, and the canonical cubes of those that aren't in the table yet are the cubes of the next depth. Their first
+ * move is the move back, turned by the symmetry that made them canonical.
+ *
+ * @param _depth Largest number of moves from solved of the cubes in the table, at most MAX_DEPTH
+ */
+EndgameTable::EndgameTable(int _depth)
+: maxDepth(std::max(0, std::min(_depth, MAX_DEPTH))), entries(0), slots(1024, 0)
+{
+    const RubixCube solved;
+    std::vector<RubixCube> frontier(1, solved);
+    std::vector<RubixCube> next;
+
+    for (int depth = 1; depth <= maxDepth; depth++)
+    {
+        next.clear();
+        for (const RubixCube &cube : frontier)
+        {
+            for (int move = 0; move < 18; move++)
+            {
+                RubixCube moved = cube;
+                moved.applyMove(move);
+                int symmetry;
+                RubixCube canonical = moved.canonical(&symmetry);
+                if (canonical == solved || find(canonical) != 0)
+                    continue;
+
+                insert(canonical, RubixCube::symmetricMove(Move(inverseMove(move)), symmetry).value, depth);
+                next.push_back(canonical);
+            }
+        }
+        frontier.swap(next);
+    }
+}
+
+uint64_t EndgameTable::find(const RubixCube &canonical) const
+{
+    uint64_t hash = canonical.hash();
+    uint64_t key = hash & ~ENTRY_MASK;
+    size_t mask = slots.size() - 1;
+    for (size_t i = (hash >> ENTRY_BITS) & mask; slots[i] != 0; i = (i + 1) & mask)
+    {
+        if ((slots[i] & ~ENTRY_MASK) == key)
+            return slots[i];
+    }
+    return 0;
+}
+
+int EndgameTable::distance(const RubixCube &canonical) const
+{
+    if (canonical == RubixCube())
+        return 0;
+    uint64_t entry = find(canonical);
+    return entry != 0 ? (entry & ENTRY_MASK) >> MOVE_BITS : -1;
+}
+
+void EndgameTable::insert(const RubixCube &canonical, int move, int distance)
+{
+    // At most half full so a lookup of a cube that isn't there soon reaches an empty slot
+    if ((entries + 1) * 2 > slots.size())
+        grow();
+
+    uint64_t hash = canonical.hash();
+    size_t mask = slots.size() - 1;
+    size_t i = (hash >> ENTRY_BITS) & mask;
+    while (slots[i] != 0)
+        i = (i + 1) & mask;
+    slots[i] = (hash & ~ENTRY_MASK) | distance << MOVE_BITS | (move + 1);
+    entries++;
+}
+
+void EndgameTable::grow()
+{
+    std::vector<uint64_t> old(slots.size() * 2, 0);
+    old.swap(slots);
+
+    size_t mask = slots.size() - 1;
+    for (uint64_t slot : old)
+    {
+        if (slot == 0)
+            continue;
+        size_t i = (slot >> ENTRY_BITS) & mask;
+        while (slots[i] != 0)
+            i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+}
+
+/**
+ * @brief Follows the table from the cube to the solved cube. Two cubes can share the bits of their hashes that are
+ * kept, so the moves found are checked to really solve the cube, and a cube that the table leads astray is not solved.
+ */
+bool EndgameTable::solve(const RubixCube &cube, MoveSequence &solution) const
+{
+    const RubixCube solved;
+    RubixCube current = cube;
+    solution.clear();
+
+    for (int moves = 0; moves < maxDepth && current != solved; moves++)
+    {
+        int symmetry;
+        uint64_t entry = find(current.canonical(&symmetry));
+        if (entry == 0)
+            return false;
+
+        Move turned = RubixCube::symmetricMove(Move((entry & MOVE_MASK) - 1), RubixCube::inverseSymmetry(symmetry));
+        current.applyMove(turned);
+        solution.push_back(turned);
+    }
+
+    return current == solved;
+}
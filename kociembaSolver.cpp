@@ -0,0 +1,448 @@
+#include "kociembaSolver.hpp"
+#include <vector>
+#include <algorithm>
+
+// #######################
+// Coordinates
+// #######################
+
+// Each coordinate numbers one aspect of the cube so that the solved cube is 0.
+// Phase one uses the corner twist, edge flip and which positions hold the four middle layer (slice) edges.
+// Phase two uses the corner permutation, the permutation of the eight U/D edges and of the four slice edges.
+
+static const int TWISTS = 2187; // 3^7
+static const int FLIPS = 2048; // 2^11
+static const int SLICES = 495; // 12 choose 4
+static const int CORNER_PERMS = 40320; // 8!
+static const int EDGE_PERMS = 40320; // 8!
+static const int SLICE_PERMS = 24; // 4!
+
+static const int MAX_PHASE2 = 12;
+
+// U, D, R2, L2, F2, B2 are the only moves allowed in phase two
+static const uint8_t phase2Moves[10] = {UP * 3, UP * 3 + 1, UP * 3 + 2, DOWN * 3, DOWN * 3 + 1, DOWN * 3 + 2, LEFT * 3 + 1, RIGHT * 3 + 1, FRONT * 3 + 1, BACK * 3 + 1};
+
+static int binomial(int n, int k)
+{
+    if (k > n)
+        return 0;
+
+    int result = 1;
+    for (int i = 1; i <= k; i++)
+        result = result * (n - k + i) / i;
+    return result;
+}
+
+static int getTwist(const CubieCube &cube)
+{
+    int twist = 0;
+    for (int i = 0; i < 7; i++)
+        twist = twist * 3 + cube.cornerTwist(i);
+    return twist;
+}
+
+static void setTwist(CubieCube &cube, int twist)
+{
+    int total = 0;
+    for (int i = 6; i >= 0; i--)
+    {
+        cube.corners[i] = (cube.corners[i] & 7) | (twist % 3) << 3;
+        total += twist % 3;
+        twist /= 3;
+    }
+    // The twist of the last corner is fixed by the others
+    cube.corners[7] = (cube.corners[7] & 7) | ((3 - total % 3) % 3) << 3;
+}
+
+static int getFlip(const CubieCube &cube)
+{
+    int flip = 0;
+    for (int i = 0; i < 11; i++)
+        flip = flip * 2 + cube.edgeFlip(i);
+    return flip;
+}
+
+static void setFlip(CubieCube &cube, int flip)
+{
+    int total = 0;
+    for (int i = 10; i >= 0; i--)
+    {
+        cube.edges[i] = (cube.edges[i] & 15) | (flip & 1) << 4;
+        total += flip & 1;
+        flip >>= 1;
+    }
+    cube.edges[11] = (cube.edges[11] & 15) | (total & 1) << 4;
+}
+
+// The positions of the slice edges are numbered with the combinatorial number system, counted from BR down to UR
+static int getSlice(const CubieCube &cube)
+{
+    int slice = 0;
+    int found = 0;
+    for (int j = 11; j >= 0; j--)
+    {
+        if (cube.edgePiece(j) >= FR)
+        {
+            found++;
+            slice += binomial(11 - j, found);
+        }
+    }
+    return slice;
+}
+
+static void setSlice(CubieCube &cube, int slice)
+{
+    bool inSlice[12] = {};
+    for (int k = 4; k > 0; k--)
+    {
+        int offset = k - 1;
+        while (binomial(offset + 1, k) <= slice)
+            offset++;
+        slice -= binomial(offset, k);
+        inSlice[11 - offset] = true;
+    }
+
+    int sliceEdge = FR;
+    int otherEdge = UR;
+    for (int j = 0; j < 12; j++)
+        cube.edges[j] = inSlice[j] ? sliceEdge++ : otherEdge++;
+}
+
+// Permutations are numbered by their Lehmer code so the identity is 0
+static int getPermutation(const uint8_t *pieces, int count)
+{
+    int rank = 0;
+    for (int i = 0; i < count; i++)
+    {
+        int smaller = 0;
+        for (int j = i + 1; j < count; j++)
+        {
+            if (pieces[j] < pieces[i])
+                smaller++;
+        }
+        rank = rank * (count - i) + smaller;
+    }
+    return rank;
+}
+
+static void setPermutation(uint8_t *pieces, int count, int rank, int first)
+{
+    uint8_t digits[8];
+    for (int i = count - 1; i >= 0; i--)
+    {
+        digits[i] = rank % (count - i);
+        rank /= count - i;
+    }
+
+    // Each digit is how many of the unused pieces are smaller than the piece in that position
+    bool used[8] = {};
+    for (int i = 0; i < count; i++)
+    {
+        int piece = 0;
+        for (int smaller = digits[i]; used[piece] || smaller > 0; piece++)
+        {
+            if (!used[piece])
+                smaller--;
+        }
+        used[piece] = true;
+        pieces[i] = first + piece;
+    }
+}
+
+static int getCornerPerm(const CubieCube &cube)
+{
+    uint8_t pieces[8];
+    for (int i = 0; i < 8; i++)
+        pieces[i] = cube.cornerPiece(i);
+    return getPermutation(pieces, 8);
+}
+
+static void setCornerPerm(CubieCube &cube, int perm)
+{
+    setPermutation(cube.corners, 8, perm, URF);
+}
+
+static int getEdgePerm(const CubieCube &cube)
+{
+    uint8_t pieces[8];
+    for (int i = 0; i < 8; i++)
+        pieces[i] = cube.edgePiece(i);
+    return getPermutation(pieces, 8);
+}
+
+static void setEdgePerm(CubieCube &cube, int perm)
+{
+    setPermutation(cube.edges, 8, perm, UR);
+}
+
+static int getSlicePerm(const CubieCube &cube)
+{
+    uint8_t pieces[4];
+    for (int i = 0; i < 4; i++)
+        pieces[i] = cube.edgePiece(FR + i);
+    return getPermutation(pieces, 4);
+}
+
+static void setSlicePerm(CubieCube &cube, int perm)
+{
+    setPermutation(cube.edges + FR, 4, perm, FR);
+}
+
+// #######################
+// Move and Pruning Tables
+// #######################
+
+struct KociembaTables
+{
+    // Coordinate after a move, indexed [coordinate * moves + move]. Phase two tables only hold the phase two moves.
+    std::vector<uint16_t> twistMove;
+    std::vector<uint16_t> flipMove;
+    std::vector<uint16_t> sliceMove;
+    std::vector<uint16_t> cornerPermMove;
+    std::vector<uint16_t> edgePermMove;
+    std::vector<uint16_t> slicePermMove;
+
+    // Lower bound on the moves left in a phase, indexed by a pair of that phase's coordinates
+    std::vector<uint8_t> sliceTwistPrune;
+    std::vector<uint8_t> sliceFlipPrune;
+    std::vector<uint8_t> cornerSlicePrune;
+    std::vector<uint8_t> edgeSlicePrune;
+};
+
+/**
+ * @brief Builds the table of a coordinate after each move by setting the coordinate on a solved cube
+ * and applying the move to it.
+ */
+static std::vector<uint16_t> buildMoveTable(int size, void (*setCoordinate)(CubieCube &, int), int (*getCoordinate)(const CubieCube &), const uint8_t *moves, int moveCount)
+{
+    std::vector<uint16_t> table(size * moveCount);
+
+    for (int coordinate = 0; coordinate < size; coordinate++)
+    {
+        CubieCube cube;
+        setCoordinate(cube, coordinate);
+
+        for (int m = 0; m < moveCount; m++)
+        {
+            CubieCube moved = cube;
+            moved.applyMove(moves[m]);
+            table[coordinate * moveCount + m] = getCoordinate(moved);
+        }
+    }
+
+    return table;
+}
+
+/**
+ * @brief Breadth first search from the solved state over a pair of coordinates, recording the distance of each pair.
+ */
+static std::vector<uint8_t> buildPruneTable(const std::vector<uint16_t> &moveA, int sizeA, const std::vector<uint16_t> &moveB, int sizeB, int moveCount)
+{
+    std::vector<uint8_t> table(sizeA * sizeB, 0xFF);
+    int filled = 1;
+    table[0] = 0;
+
+    for (uint8_t depth = 0; filled < sizeA * sizeB; depth++)
+    {
+        for (int index = 0; index < sizeA * sizeB; index++)
+        {
+            if (table[index] != depth)
+                continue;
+
+            int a = index / sizeB;
+            int b = index % sizeB;
+            for (int m = 0; m < moveCount; m++)
+            {
+                int next = moveA[a * moveCount + m] * sizeB + moveB[b * moveCount + m];
+                if (table[next] == 0xFF)
+                {
+                    table[next] = depth + 1;
+                    filled++;
+                }
+            }
+        }
+    }
+
+    return table;
+}
+
+static const KociembaTables & kociembaTables()
+{
+    static const KociembaTables tables = []()
+    {
+        uint8_t allMoves[18];
+        for (int m = 0; m < 18; m++)
+            allMoves[m] = m;
+
+        KociembaTables t;
+        t.twistMove = buildMoveTable(TWISTS, setTwist, getTwist, allMoves, 18);
+        t.flipMove = buildMoveTable(FLIPS, setFlip, getFlip, allMoves, 18);
+        t.sliceMove = buildMoveTable(SLICES, setSlice, getSlice, allMoves, 18);
+        t.cornerPermMove = buildMoveTable(CORNER_PERMS, setCornerPerm, getCornerPerm, phase2Moves, 10);
+        t.edgePermMove = buildMoveTable(EDGE_PERMS, setEdgePerm, getEdgePerm, phase2Moves, 10);
+        t.slicePermMove = buildMoveTable(SLICE_PERMS, setSlicePerm, getSlicePerm, phase2Moves, 10);
+
+        t.sliceTwistPrune = buildPruneTable(t.sliceMove, SLICES, t.twistMove, TWISTS, 18);
+        t.sliceFlipPrune = buildPruneTable(t.sliceMove, SLICES, t.flipMove, FLIPS, 18);
+        t.cornerSlicePrune = buildPruneTable(t.cornerPermMove, CORNER_PERMS, t.slicePermMove, SLICE_PERMS, 10);
+        t.edgeSlicePrune = buildPruneTable(t.edgePermMove, EDGE_PERMS, t.slicePermMove, SLICE_PERMS, 10);
+        return t;
+    }();
+
+    return tables;
+}
+
+// #######################
+// KociembaSolver Class
+// #######################
+
+KociembaSolver::KociembaSolver(int _targetLength, int _timeLimit)
+: targetLength(_targetLength), timeLimit(_timeLimit), maxLength(0), bestLength(0)
+{}
+
+// A move is skipped if it turns the same face as the previous move or if it turns the
+// opposite face in the wrong order, since opposite faces commute.
+static bool redundantMove(int face, int previousFace)
+{
+    return face == previousFace || (face / 2 == previousFace / 2 && face < previousFace);
+}
+
+/**
+ * @brief Finds a short solution for the cube. The search keeps looking for shorter solutions
+ * until one of targetLength moves is found or timeLimit has passed since the first solution.
+ *
+ * @param cube The cube to solve, it must be a valid cube
+ * @return MoveSet Half turns are returned as two CW turns
+ */
+MoveSet KociembaSolver::solveCube(RubixCube & cube)
+{
+    const KociembaTables &t = kociembaTables();
+    MoveSet moveSet;
+
+    // Pieces that aren't on the cube have no coordinates, so an unsolvable cube can't be searched at all
+    CubeValidation validation = CubieCube::validate(cube);
+    if (!validation.valid())
+        throw SolverError("Unsolvable cube, " + validation.reason());
+
+    startCube = CubieCube(cube);
+    maxLength = 30;
+    bestLength = -1;
+    deadline = std::chrono::steady_clock::time_point::max();
+
+    int twist = getTwist(startCube);
+    int flip = getFlip(startCube);
+    int slice = getSlice(startCube);
+    int start = std::max(t.sliceTwistPrune[slice * TWISTS + twist], t.sliceFlipPrune[slice * FLIPS + flip]);
+
+    // Every valid cube reaches phase two in at most 12 moves
+    for (int depth = start; depth <= 20 && depth < maxLength; depth++)
+    {
+        if (phase1(twist, flip, slice, 0, depth))
+            break;
+    }
+
+    // An empty move set means the cube was already solved, so a cube the search gave up on is an error
+    if (bestLength < 0)
+        throw SolverError("KociembaSolver found no solution within " + std::to_string(maxLength) + " moves on " + cube.toFacelets());
+
+    for (int i = 0; i < bestLength; i++)
+        appendMove(moveSet, bestPath[i]);
+
+    return moveSet;
+}
+
+/**
+ * @brief Searches phase one solutions of exactly depth + togo moves.
+ *
+ * @return true when the search is finished
+ */
+bool KociembaSolver::phase1(int twist, int flip, int slice, int depth, int togo)
+{
+    const KociembaTables &t = kociembaTables();
+
+    if (togo == 0)
+    {
+        // Phase one solutions ending in a phase two move were already covered by a shorter phase one
+        if (twist == 0 && flip == 0 && slice == 0 && (depth == 0 || (path[depth - 1] / 3 > DOWN && path[depth - 1] % 3 != 1)))
+            return startPhase2(depth);
+        return false;
+    }
+
+    for (int move = 0; move < 18; move++)
+    {
+        if (depth > 0 && redundantMove(move / 3, path[depth - 1] / 3))
+            continue;
+
+        int nextTwist = t.twistMove[twist * 18 + move];
+        int nextFlip = t.flipMove[flip * 18 + move];
+        int nextSlice = t.sliceMove[slice * 18 + move];
+        if (std::max(t.sliceTwistPrune[nextSlice * TWISTS + nextTwist], t.sliceFlipPrune[nextSlice * FLIPS + nextFlip]) >= togo)
+            continue;
+
+        path[depth] = move;
+        if (phase1(nextTwist, nextFlip, nextSlice, depth + 1, togo - 1))
+            return true;
+    }
+
+    return false;
+}
+
+bool KociembaSolver::startPhase2(int depth)
+{
+    const KociembaTables &t = kociembaTables();
+
+    CubieCube cube = startCube;
+    for (int i = 0; i < depth; i++)
+        cube.applyMove(path[i]);
+
+    int cornerPerm = getCornerPerm(cube);
+    int edgePerm = getEdgePerm(cube);
+    int slicePerm = getSlicePerm(cube);
+    int start = std::max(t.cornerSlicePrune[cornerPerm * SLICE_PERMS + slicePerm], t.edgeSlicePrune[edgePerm * SLICE_PERMS + slicePerm]);
+
+    // Long phase two searches rarely pay off compared to trying the next phase one solution
+    for (int togo = start; togo <= MAX_PHASE2 && depth + togo < maxLength; togo++)
+    {
+        if (phase2(cornerPerm, edgePerm, slicePerm, depth, togo))
+        {
+            bestLength = depth + togo;
+            std::copy(path, path + bestLength, bestPath);
+            maxLength = bestLength;
+
+            if (bestLength <= targetLength)
+                return true;
+            if (deadline == std::chrono::steady_clock::time_point::max())
+                deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeLimit);
+            break;
+        }
+    }
+
+    return std::chrono::steady_clock::now() > deadline;
+}
+
+bool KociembaSolver::phase2(int cornerPerm, int edgePerm, int slicePerm, int depth, int togo)
+{
+    const KociembaTables &t = kociembaTables();
+
+    if (togo == 0)
+        return cornerPerm == 0 && edgePerm == 0 && slicePerm == 0;
+
+    for (int m = 0; m < 10; m++)
+    {
+        int move = phase2Moves[m];
+        if (depth > 0 && redundantMove(move / 3, path[depth - 1] / 3))
+            continue;
+
+        int nextCornerPerm = t.cornerPermMove[cornerPerm * 10 + m];
+        int nextEdgePerm = t.edgePermMove[edgePerm * 10 + m];
+        int nextSlicePerm = t.slicePermMove[slicePerm * 10 + m];
+        if (std::max(t.cornerSlicePrune[nextCornerPerm * SLICE_PERMS + nextSlicePerm], t.edgeSlicePrune[nextEdgePerm * SLICE_PERMS + nextSlicePerm]) >= togo)
+            continue;
+
+        path[depth] = move;
+        if (phase2(nextCornerPerm, nextEdgePerm, nextSlicePerm, depth + 1, togo - 1))
+            return true;
+    }
+
+    return false;
+}
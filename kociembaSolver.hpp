@@ -0,0 +1,34 @@
+#pragma once
+#include "rubixCube.hpp"
+#include "cubieCube.hpp"
+#include <chrono>
+
+// Two phase solver (Herbert Kociemba's algorithm). Phase one moves the cube into the group generated by
+// U, D, R2, L2, F2, B2 and phase two solves it using only those moves. Both phases are an IDA* search over
+// small coordinates with precomputed move and pruning tables, which are built the first time a solver is used.
+class KociembaSolver
+{
+    public:
+    KociembaSolver(int _targetLength = 21, int _timeLimit = 100);
+
+    // Throws SolverError for a cube that can't be solved, or if no solution is found
+    MoveSet solveCube(RubixCube & cube);
+
+    // Length of the last solution counting half turns as one move
+    int solutionLength() const { return bestLength; }
+
+    private:
+    bool phase1(int twist, int flip, int slice, int depth, int togo);
+    bool phase2(int cornerPerm, int edgePerm, int slicePerm, int depth, int togo);
+    bool startPhase2(int depth);
+
+    int targetLength; // Searching stops as soon as a solution this short is found
+    int timeLimit; // Milliseconds to keep looking for shorter solutions once one is found
+    int maxLength;
+    int bestLength;
+    std::chrono::steady_clock::time_point deadline;
+
+    CubieCube startCube;
+    uint8_t path[32]; // Moves of the current search branch, face * 3 + turn
+    uint8_t bestPath[32];
+};
@@ -0,0 +1,145 @@
+#include "notation.hpp"
+#include <array>
+#include <cstring>
+
+static const uint8_t NOT_A_FACE = 0xFF;
+static const char FACE_LETTERS[] = "UDLRFB";
+
+static constexpr std::array<uint8_t, 256> buildFaceCodes()
+{
+    std::array<uint8_t, 256> codes = {};
+    for (int i = 0; i < 256; i++)
+        codes[i] = NOT_A_FACE;
+    for (int face = 0; face < 6; face++)
+        codes[static_cast<uint8_t>(FACE_LETTERS[face])] = face;
+    return codes;
+}
+
+static constexpr std::array<uint8_t, 256> buildTurnCodes()
+{
+    std::array<uint8_t, 256> codes = {};
+    codes['2'] = HALF_TURN;
+    codes['\''] = COUNTER_CLOCKWISE;
+    return codes;
+}
+
+// Face of each character and the turn of each character that can follow a face, so reading a move is two
+// table lookups instead of a chain of comparisons.
+static constexpr std::array<uint8_t, 256> faceCodes = buildFaceCodes();
+static constexpr std::array<uint8_t, 256> turnCodes = buildTurnCodes();
+
+/**
+ * @brief Reads moves up to the end of the line and hands each one to apply.
+ */
+template <typename Apply>
+static NotationResult parseLine(const char *begin, const char *end, Apply apply)
+{
+    const char *p = begin;
+    uint32_t moves = 0;
+
+    while (p < end)
+    {
+        uint8_t face = faceCodes[static_cast<uint8_t>(*p)];
+        if (face == NOT_A_FACE)
+        {
+            char c = *p;
+            if (c == '\n')
+                return {p + 1, moves, true};
+            if (c != ' ' && c != '\t' && c != '\r')
+                return {p, moves, false};
+            p++;
+            continue;
+        }
+
+        uint8_t turn = p + 1 < end ? turnCodes[static_cast<uint8_t>(p[1])] : static_cast<uint8_t>(CLOCKWISE);
+        p += 1 + (turn != CLOCKWISE);
+        // R2' turns the same as R2
+        if (turn == HALF_TURN && p < end && *p == '\'')
+            p++;
+
+        apply(Move(static_cast<RubixFace>(face), static_cast<RubixTurn>(turn)));
+        moves++;
+    }
+
+    return {p, moves, true};
+}
+
+NotationResult parseNotation(const char *begin, const char *end, RubixCube &cube)
+{
+    return parseLine(begin, end, [&cube](Move move) { cube.applyMove(move); });
+}
+
+NotationResult parseNotation(const char *begin, const char *end, MoveSequence &moves)
+{
+    return parseLine(begin, end, [&moves](Move move) { moves.push_back(move); });
+}
+
+size_t parseScrambles(const char *begin, const char *end, RubixCube *cubes, size_t count, const char **next)
+{
+    size_t filled = 0;
+    const char *line = begin;
+
+    while (filled < count && line < end)
+    {
+        RubixCube &cube = cubes[filled];
+        cube.reset();
+
+        NotationResult result = parseNotation(line, end, cube);
+        if (!result.valid)
+            break;
+
+        // A line without moves is blank, its cube is reused for the next line
+        if (result.moves > 0)
+            filled++;
+        line = result.next;
+    }
+
+    *next = line;
+    return filled;
+}
+
+// Adds a move to the text of length characters so far, writing only what fits in the size characters of buffer
+static size_t formatMove(char *buffer, size_t size, size_t length, RubixFace face, RubixTurn turn, bool first)
+{
+    char text[MAX_MOVE_NOTATION];
+    size_t textLength = 0;
+
+    if (!first)
+        text[textLength++] = ' ';
+    text[textLength++] = FACE_LETTERS[face];
+    if (turn == HALF_TURN)
+        text[textLength++] = '2';
+    else if (turn == COUNTER_CLOCKWISE)
+        text[textLength++] = '\'';
+
+    for (size_t i = 0; i < textLength; i++, length++)
+    {
+        if (length < size)
+            buffer[length] = text[i];
+    }
+    return length;
+}
+
+size_t formatNotation(const Move *moves, size_t count, char *buffer, size_t size)
+{
+    size_t length = 0;
+    for (size_t i = 0; i < count; i++)
+        length = formatMove(buffer, size, length, moves[i].face(), moves[i].turn(), i == 0);
+    return length;
+}
+
+size_t formatNotation(const MoveSequence &moves, char *buffer, size_t size)
+{
+    return formatNotation(moves.begin(), moves.size(), buffer, size);
+}
+
+size_t formatNotation(const MoveSet &moveSet, char *buffer, size_t size)
+{
+    size_t length = 0;
+    for (size_t i = 0; i < moveSet.size(); i++)
+    {
+        RubixTurn turn = std::strcmp(std::get<2>(moveSet[i]), "CCW") == 0 ? COUNTER_CLOCKWISE : CLOCKWISE;
+        length = formatMove(buffer, size, length, std::get<0>(moveSet[i]), turn, i == 0);
+    }
+    return length;
+}
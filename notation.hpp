@@ -0,0 +1,32 @@
+#pragma once
+#include "rubixCube.hpp"
+
+// Singmaster notation: a face letter (U, D, L, R, F or B) followed by ' for a CCW turn or 2 for a half turn,
+// for example "R U R' U2 F'". Moves may be separated by spaces or tabs and a line break ends a sequence.
+// Nothing here allocates, so text can be parsed straight out of a large buffer or a memory mapped file.
+
+// Longest text of one formatted move, including the space in front of it
+static const size_t MAX_MOVE_NOTATION = 3;
+
+struct NotationResult
+{
+    const char *next; // Just past the line break that ended the sequence, or at the first invalid character
+    uint32_t moves; // Number of moves read
+    bool valid;
+};
+
+// Reads one line of moves and applies them to the cube as they are read
+NotationResult parseNotation(const char *begin, const char *end, RubixCube &cube);
+// Reads one line of moves and adds them to the end of the sequence
+NotationResult parseNotation(const char *begin, const char *end, MoveSequence &moves);
+
+// Reads up to count scrambles, one per line, and applies each to a solved cube. Empty lines are skipped.
+// Returns the number of cubes filled and sets next to the first line that was not read, which is an
+// invalid line if fewer than count cubes were filled and next is not end.
+size_t parseScrambles(const char *begin, const char *end, RubixCube *cubes, size_t count, const char **next);
+
+// Write moves separated by spaces into buffer without a terminating zero. Like snprintf the return value is
+// the length of the whole text, and only the first size characters are written if the buffer is too short.
+size_t formatNotation(const Move *moves, size_t count, char *buffer, size_t size);
+size_t formatNotation(const MoveSequence &moves, char *buffer, size_t size);
+size_t formatNotation(const MoveSet &moveSet, char *buffer, size_t size);
@@ -0,0 +1,329 @@
+#include "optimalSolver.hpp"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <algorithm>
+
+// #######################
+// Pattern Databases
+// #######################
+
+struct OptimalDatabases
+{
+    PatternDatabase corners;
+    PatternDatabase edgesA; // UR, UF, UL, UB, DR, DF
+    PatternDatabase edgesB; // DL, DB, FR, FL, BL, BR
+};
+
+static std::string databaseDirectory = ".";
+
+static const char *CORNER_DATABASE_NAME = "corners";
+static const char *EDGE_A_DATABASE_NAME = "edges-ur-df";
+static const char *EDGE_B_DATABASE_NAME = "edges-dl-br";
+
+static std::string databasePath(const std::string &directory, const std::string &name)
+{
+    return directory + "/" + name + ".pdb";
+}
+
+template <typename Build>
+static PatternDatabase loadDatabase(const std::string &name, uint64_t entries, Build build)
+{
+    std::string path = databasePath(databaseDirectory, name);
+    PatternDatabase database;
+
+    if (!PatternDatabase::load(path, name, entries, database))
+    {
+        std::cout << "Generating pattern database " << path << std::endl;
+        database = build();
+        database.save(path, name);
+    }
+
+    return database;
+}
+
+static const OptimalDatabases & optimalDatabases()
+{
+    static const OptimalDatabases databases = {
+        loadDatabase(CORNER_DATABASE_NAME, CORNER_DATABASE_SIZE, []() { return buildCornerDatabase(); }),
+        loadDatabase(EDGE_A_DATABASE_NAME, EDGE_DATABASE_SIZE, []() { return buildEdgeDatabase(UR); }),
+        loadDatabase(EDGE_B_DATABASE_NAME, EDGE_DATABASE_SIZE, []() { return buildEdgeDatabase(DL); })
+    };
+    return databases;
+}
+
+// Distances of a state in each database, worked out from the distances of a neighbouring state
+static void estimateDistances(const OptimalDatabases &databases, const PieceState &state, const uint8_t *neighbour, uint8_t *distances)
+{
+    distances[0] = databases.corners.distance(cornerIndex(state), neighbour[0]);
+    distances[1] = databases.edgesA.distance(edgeIndex(state, UR), neighbour[1]);
+    distances[2] = databases.edgesB.distance(edgeIndex(state, DL), neighbour[2]);
+}
+
+/**
+ * @brief Exact distance of a state in a database. A 2 bit database only knows distances mod 3, so this
+ * follows moves that get one closer to solved until it gets there and counts them.
+ *
+ * @return false if the database is corrupted: no move gets closer, or it takes more moves than any
+ * database distance can be
+ */
+template <typename GetIndex>
+static bool exactDistance(const PatternDatabase &database, PieceState state, GetIndex getIndex, uint8_t &distance)
+{
+    distance = 0;
+    if (database.bitsPerEntry() == 4)
+    {
+        distance = database.distance(getIndex(state));
+        return distance != PatternDatabase::UNKNOWN;
+    }
+
+    uint64_t solved = getIndex(PieceState());
+    for (uint64_t index = getIndex(state); index != solved; distance++)
+    {
+        if (distance >= PatternDatabase::UNKNOWN)
+            return false;
+
+        uint8_t closer = (database.entry(index) + 2) % 3;
+        int move = 0;
+        for (; move < 18; move++)
+        {
+            PieceState next = state;
+            uint64_t nextIndex = getIndex(next.applyMove(move));
+            if (database.entry(nextIndex) == closer)
+            {
+                state = next;
+                index = nextIndex;
+                break;
+            }
+        }
+        if (move == 18)
+            return false;
+    }
+
+    return true;
+}
+
+// Each database only counts the moves for its own pieces so the largest is still a lower bound
+static int estimateDistance(const uint8_t *distances)
+{
+    return std::max(distances[0], std::max(distances[1], distances[2]));
+}
+
+// A move is skipped if it turns the same face as the previous move or if it turns the
+// opposite face in the wrong order, since opposite faces commute.
+static bool redundantMove(int face, int previousFace)
+{
+    return face == previousFace || (face / 2 == previousFace / 2 && face < previousFace);
+}
+
+// #######################
+// OptimalSolver Class
+// #######################
+
+struct OptimalSolver::SearchNode
+{
+    PieceState state;
+    uint8_t distances[3];
+};
+
+OptimalSolver::OptimalSolver(int _threads, int _timeLimit)
+: threads(_threads > 0 ? _threads : std::max(1u, std::thread::hardware_concurrency())), timeLimit(_timeLimit), stop(false), timedOut(false), length(-1), nodes(0), seconds(0)
+{}
+
+void OptimalSolver::useDatabaseDirectory(const std::string &directory)
+{
+    databaseDirectory = directory;
+}
+
+/**
+ * @brief Builds the pattern databases and saves them to a directory, replacing any that are there.
+ *
+ * @param bitsPerEntry 4 or 2, 2 bits halves the size of the files and makes every lookup a little slower
+ * @return true if every database was saved and reads back with a matching checksum
+ */
+bool OptimalSolver::generateDatabases(const std::string &directory, int bitsPerEntry, int threads)
+{
+    bool saved = true;
+    auto generate = [&](const char *name, PatternDatabase (*build)(int))
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::string path = databasePath(directory, name);
+        PatternDatabase database = build(threads);
+        PatternDatabase loaded;
+        saved = database.save(path, name, bitsPerEntry) && PatternDatabase::load(path, name, database.size(), loaded, true) && saved;
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Generated " << path << " (" << database.size() << " entries) in " << elapsed.count() << " seconds." << std::endl;
+    };
+
+    generate(CORNER_DATABASE_NAME, buildCornerDatabase);
+    generate(EDGE_A_DATABASE_NAME, [](int threads) { return buildEdgeDatabase(UR, threads); });
+    generate(EDGE_B_DATABASE_NAME, [](int threads) { return buildEdgeDatabase(DL, threads); });
+
+    return saved;
+}
+
+/**
+ * @brief Finds a shortest solution for the cube.
+ *
+ * @param cube The cube to solve
+ * @return MoveSet Half turns are returned as two CW turns, empty only for a solved cube
+ */
+MoveSet OptimalSolver::solveCube(RubixCube & cube)
+{
+    // Pieces that aren't on the cube have no database indices, so an unsolvable cube can't be searched at all
+    CubeValidation validation = CubieCube::validate(cube);
+    if (!validation.valid())
+        throw SolverError("Unsolvable cube, " + validation.reason());
+
+    const OptimalDatabases &databases = optimalDatabases();
+    SearchNode start;
+    start.state = CubieCube(cube);
+    if (!exactDistance(databases.corners, start.state, cornerIndex, start.distances[0])
+        || !exactDistance(databases.edgesA, start.state, [](const PieceState &state) { return edgeIndex(state, UR); }, start.distances[1])
+        || !exactDistance(databases.edgesB, start.state, [](const PieceState &state) { return edgeIndex(state, DL); }, start.distances[2]))
+        throw SolverError("The pattern databases in " + databaseDirectory + " are corrupted, delete them to generate them again");
+    MoveSet moveSet;
+
+    auto startTime = std::chrono::steady_clock::now();
+    deadline = timeLimit > 0 ? startTime + std::chrono::seconds(timeLimit) : std::chrono::steady_clock::time_point::max();
+    stop = false;
+    timedOut = false;
+    length = -1;
+    nodes = 0;
+    iterations.clear();
+
+    for (int bound = estimateDistance(start.distances); length < 0 && !timedOut && bound <= 20; bound++)
+    {
+        auto iterationStart = std::chrono::steady_clock::now();
+        std::atomic<uint64_t> iterationNodes(0);
+
+        // Split the iteration into the subtrees below each sequence of the first two moves
+        int prefixLength = std::min(bound, 2);
+        std::vector<SearchNode> subtrees;
+        std::vector<uint16_t> prefixes;
+        for (int first = 0; first < (prefixLength > 0 ? 18 : 1); first++)
+        {
+            for (int second = 0; second < (prefixLength > 1 ? 18 : 1); second++)
+            {
+                if (prefixLength > 1 && redundantMove(second / 3, first / 3))
+                    continue;
+
+                SearchNode node = start;
+                if (prefixLength > 0)
+                    estimateDistances(databases, node.state.applyMove(first), start.distances, node.distances);
+                if (prefixLength > 1)
+                {
+                    uint8_t distances[3] = {node.distances[0], node.distances[1], node.distances[2]};
+                    estimateDistances(databases, node.state.applyMove(second), distances, node.distances);
+                }
+                subtrees.push_back(node);
+                prefixes.push_back(first * 18 + second);
+            }
+        }
+
+        std::atomic<int> next(0);
+        std::vector<std::thread> workers;
+        for (int i = 1; i < threads; i++)
+            workers.emplace_back(&OptimalSolver::searchSubtrees, this, std::cref(subtrees), std::cref(prefixes), prefixLength, bound, std::ref(next), std::ref(iterationNodes));
+        searchSubtrees(subtrees, prefixes, prefixLength, bound, next, iterationNodes);
+        for (std::thread &worker : workers)
+            worker.join();
+
+        std::chrono::duration<double> iterationTime = std::chrono::steady_clock::now() - iterationStart;
+        iterations.push_back({bound, iterationNodes, iterationTime.count()});
+        nodes += iterationNodes;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    seconds = elapsed.count();
+
+    // An empty move set means the cube was already solved, so running out of time is an error
+    if (length < 0)
+    {
+        if (timedOut)
+            throw SolverError("OptimalSolver ran out of time, the solution is longer than " + std::to_string(iterations.back().depth - 1) + " moves on " + cube.toFacelets());
+        throw SolverError("OptimalSolver found no solution within 20 moves on " + cube.toFacelets());
+    }
+
+    for (int i = 0; i < length; i++)
+        appendMove(moveSet, solution[i]);
+
+    return moveSet;
+}
+
+/**
+ * @brief Worker loop that takes subtrees off the shared list until none are left or a solution is found
+ */
+void OptimalSolver::searchSubtrees(const std::vector<SearchNode> &subtrees, const std::vector<uint16_t> &prefixes, int prefixLength, int bound, std::atomic<int> &next, std::atomic<uint64_t> &totalNodes)
+{
+    uint8_t path[32];
+    uint64_t searched = 0;
+
+    for (int i = next++; i < (int)subtrees.size() && !stop; i = next++)
+    {
+        path[0] = prefixes[i] / 18;
+        path[1] = prefixes[i] % 18;
+        search(subtrees[i], prefixLength, bound, path, searched);
+    }
+
+    totalNodes += searched;
+}
+
+bool OptimalSolver::search(const SearchNode &node, int depth, int bound, uint8_t *path, uint64_t &searched)
+{
+    int estimate = estimateDistance(node.distances);
+    searched++;
+
+    if (depth + estimate > bound)
+        return false;
+
+    // Only a solved cube is solved in every database
+    if (estimate == 0)
+    {
+        std::lock_guard<std::mutex> lock(solutionMutex);
+        if (!stop)
+        {
+            length = depth;
+            std::copy(path, path + depth, solution);
+            stop = true;
+        }
+        return true;
+    }
+
+    if ((searched & 0xFFFF) == 0 && std::chrono::steady_clock::now() > deadline)
+    {
+        timedOut = true;
+        stop = true;
+    }
+    if (stop)
+        return false;
+
+    const OptimalDatabases &databases = optimalDatabases();
+    for (int move = 0; move < 18; move++)
+    {
+        if (depth > 0 && redundantMove(move / 3, path[depth - 1] / 3))
+            continue;
+
+        SearchNode next;
+        next.state = node.state;
+        estimateDistances(databases, next.state.applyMove(move), node.distances, next.distances);
+        path[depth] = move;
+        if (search(next, depth + 1, bound, path, searched))
+            return true;
+    }
+
+    return false;
+}
+
+void OptimalSolver::printStats()
+{
+    std::cout << "Depth" << std::setw(16) << "Nodes" << std::setw(12) << "Seconds" << std::endl;
+    for (const DepthStats &iteration : iterations)
+        std::cout << std::setw(5) << iteration.depth << std::setw(16) << iteration.nodes << std::setw(12) << std::fixed << std::setprecision(3) << iteration.seconds << std::endl;
+
+    std::cout << "Expanded " << nodes << " nodes in " << seconds << " seconds on " << threads << " threads, "
+        << (uint64_t)nodesPerSecond() << " nodes per second." << std::endl;
+    if (timedOut)
+        std::cout << "Time limit reached, the solution is longer than " << iterations.back().depth - 1 << " moves." << std::endl;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "rubixCube.hpp"
+#include "patternDatabase.hpp"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <string>
+
+// Work done by one IDA* iteration
+struct DepthStats
+{
+    int depth;
+    uint64_t nodes;
+    double seconds;
+};
+
+// Finds provably shortest solutions with IDA* (Richard Korf's method). The distance estimate is the largest of
+// the corner and two edge pattern databases, which are loaded from the database directory the first time an
+// OptimalSolver is used. Missing databases are generated and saved there for the next process.
+// Each iteration is split into subtrees by its first two moves and the subtrees are searched in parallel.
+class OptimalSolver
+{
+    public:
+    OptimalSolver(int _threads = 0, int _timeLimit = 0);
+
+    // Where the pattern database files are kept, must be set before the first solve
+    static void useDatabaseDirectory(const std::string &directory);
+    static bool generateDatabases(const std::string &directory, int bitsPerEntry = 4, int threads = 0);
+
+    // Throws SolverError for a cube that can't be solved, or if the time limit runs out before a solution is found
+    MoveSet solveCube(RubixCube & cube);
+
+    // Length of the last solution counting half turns as one move, -1 if the time limit ran out first
+    int solutionLength() const { return length; }
+    uint64_t nodesExpanded() const { return nodes; }
+    double nodesPerSecond() const { return seconds > 0 ? nodes / seconds : 0; }
+    const std::vector<DepthStats> & depthStats() const { return iterations; }
+    void printStats();
+
+    private:
+    struct SearchNode;
+
+    void searchSubtrees(const std::vector<SearchNode> &subtrees, const std::vector<uint16_t> &prefixes, int prefixLength, int bound, std::atomic<int> &next, std::atomic<uint64_t> &totalNodes);
+    bool search(const SearchNode &node, int depth, int bound, uint8_t *path, uint64_t &searched);
+
+    int threads;
+    int timeLimit; // Seconds before giving up, 0 to search until a solution is found
+    std::chrono::steady_clock::time_point deadline;
+    std::atomic<bool> stop;
+    std::atomic<bool> timedOut; // Set by whichever search thread first sees the deadline pass
+    std::mutex solutionMutex; // Lets only the first thread to solve the cube write the solution
+
+    int length;
+    uint8_t solution[32]; // Moves of the solution, face * 3 + turn
+    uint64_t nodes;
+    double seconds;
+    std::vector<DepthStats> iterations;
+};
@@ -0,0 +1,525 @@
+#include "patternDatabase.hpp"
+#include <bitset>
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define RUBIX_MMAP 1
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#define RUBIX_MMAP 0
+#endif
+
+// #######################
+// PieceState
+// #######################
+
+struct PieceMoveTables
+{
+    uint8_t corners[18][24]; // New position * 3 + twist of a corner for each move and old position * 3 + twist
+    uint8_t edges[18][24]; // New position * 2 + flip of an edge for each move and old position * 2 + flip
+};
+
+/**
+ * @brief Where each move sends a piece, read from the CubieCube version of the move
+ */
+static const PieceMoveTables & pieceMoveTables()
+{
+    static const PieceMoveTables tables = []()
+    {
+        PieceMoveTables t;
+        for (int move = 0; move < 18; move++)
+        {
+            CubieCube moveCube;
+            moveCube.applyMove(move);
+
+            // The piece from position cornerPiece(i) ends up in position i
+            for (int i = 0; i < 8; i++)
+            {
+                for (int twist = 0; twist < 3; twist++)
+                    t.corners[move][moveCube.cornerPiece(i) * 3 + twist] = i * 3 + (twist + moveCube.cornerTwist(i)) % 3;
+            }
+
+            for (int i = 0; i < 12; i++)
+            {
+                for (int flip = 0; flip < 2; flip++)
+                    t.edges[move][moveCube.edgePiece(i) * 2 + flip] = i * 2 + (flip ^ moveCube.edgeFlip(i));
+            }
+        }
+        return t;
+    }();
+
+    return tables;
+}
+
+PieceState::PieceState()
+{
+    for (int i = 0; i < 8; i++)
+        corners[i] = i * 3;
+    for (int i = 0; i < 12; i++)
+        edges[i] = i * 2;
+}
+
+PieceState::PieceState(const CubieCube &cube)
+{
+    for (int i = 0; i < 8; i++)
+        corners[cube.cornerPiece(i)] = i * 3 + cube.cornerTwist(i);
+    for (int i = 0; i < 12; i++)
+        edges[cube.edgePiece(i)] = i * 2 + cube.edgeFlip(i);
+}
+
+PieceState & PieceState::applyMove(int move)
+{
+    const PieceMoveTables &t = pieceMoveTables();
+
+    for (int i = 0; i < 8; i++)
+        corners[i] = t.corners[move][corners[i]];
+    for (int i = 0; i < 12; i++)
+        edges[i] = t.edges[move][edges[i]];
+
+    return *this;
+}
+
+// #######################
+// PatternDatabase Class
+// #######################
+
+PatternDatabase::PatternDatabase()
+: entries(0), bits(4), table(nullptr), mapping(nullptr), mappingSize(0)
+{}
+
+PatternDatabase::PatternDatabase(uint64_t _entries, std::vector<uint8_t> &&_data)
+: entries(_entries), bits(4), data(std::move(_data)), table(data.data()), mapping(nullptr), mappingSize(0)
+{}
+
+PatternDatabase::PatternDatabase(PatternDatabase &&other)
+: PatternDatabase()
+{
+    *this = std::move(other);
+}
+
+PatternDatabase & PatternDatabase::operator=(PatternDatabase &&other)
+{
+    if (this != &other)
+    {
+        release();
+        entries = other.entries;
+        bits = other.bits;
+        data = std::move(other.data);
+        table = other.mapping ? other.table : data.data();
+        mapping = other.mapping;
+        mappingSize = other.mappingSize;
+
+        other.table = nullptr;
+        other.mapping = nullptr;
+        other.entries = 0;
+    }
+    return *this;
+}
+
+PatternDatabase::~PatternDatabase()
+{
+    release();
+}
+
+void PatternDatabase::release()
+{
+#if RUBIX_MMAP
+    if (mapping)
+        munmap(mapping, mappingSize);
+#endif
+    mapping = nullptr;
+    table = nullptr;
+    data.clear();
+}
+
+uint8_t PatternDatabase::distance(uint64_t index, uint8_t neighbourDistance) const
+{
+    if (bits == 4)
+        return entry(index);
+
+    // The neighbour is at distance - 1, distance or distance + 1, which all differ mod 3
+    switch ((entry(index) + 3 - neighbourDistance % 3) % 3)
+    {
+        case 1:
+            return neighbourDistance + 1;
+        case 2:
+            return neighbourDistance - 1;
+        default:
+            return neighbourDistance;
+    }
+}
+
+static uint64_t tableBytes(uint64_t entries, int bits)
+{
+    return (entries * bits + 7) / 8;
+}
+
+// FNV-1a over the packed entries
+static uint64_t checksumBytes(const uint8_t *bytes, uint64_t count)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (uint64_t i = 0; i < count; i++)
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    return hash;
+}
+
+uint64_t PatternDatabase::checksum() const
+{
+    return checksumBytes(table, tableBytes(entries, bits));
+}
+
+// #######################
+// Database Files
+// #######################
+
+// Files start with this header followed by the packed entries. Everything is stored in the byte order of the
+// machine that generated the file, which the magic number also catches since it is read as one integer.
+struct PatternDatabaseHeader
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t bitsPerEntry;
+    uint64_t entries;
+    uint64_t dataSize;
+    uint64_t checksum;
+    char name[16]; // Which table the file holds, so a file can't be loaded as the wrong database
+    uint64_t reserved;
+};
+
+static_assert(sizeof(PatternDatabaseHeader) == 64, "Entries should start on a cache line");
+
+static const uint64_t PATTERN_DATABASE_MAGIC = 0x4244505842555221ull; // "!RUBXPDB"
+
+/**
+ * @brief Writes the table to a file with bitsPerEntry 4 or 2 bits per entry. The file is written under a
+ * temporary name and then renamed, so other processes never see a partly written file.
+ *
+ * @return true if the file was written
+ */
+bool PatternDatabase::save(const std::string &path, const std::string &name, int bitsPerEntry) const
+{
+    if (bits != 4 || (bitsPerEntry != 4 && bitsPerEntry != 2) || name.size() >= 16)
+    {
+        std::cout << "Can't save pattern database " << name << " with " << bitsPerEntry << " bits per entry" << std::endl;
+        return false;
+    }
+
+    std::vector<uint8_t> packed;
+    const uint8_t *bytes = table;
+    if (bitsPerEntry == 2)
+    {
+        packed.assign(tableBytes(entries, 2), 0);
+        for (uint64_t index = 0; index < entries; index++)
+            packed[index >> 2] |= (entry(index) % 3) << ((index & 3) * 2);
+        bytes = packed.data();
+    }
+
+    PatternDatabaseHeader header = {};
+    header.magic = PATTERN_DATABASE_MAGIC;
+    header.version = FILE_VERSION;
+    header.bitsPerEntry = bitsPerEntry;
+    header.entries = entries;
+    header.dataSize = tableBytes(entries, bitsPerEntry);
+    header.checksum = checksumBytes(bytes, header.dataSize);
+    name.copy(header.name, sizeof(header.name) - 1);
+
+    std::string temporaryPath = path + ".tmp";
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(bytes), header.dataSize);
+    file.close();
+
+    if (!file || std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        std::cout << "Failed to write pattern database " << path << std::endl;
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Loads a table saved by save. The file is memory mapped where possible so loading only reads the header,
+ * the entries are paged in by the first lookups and shared with every other process that maps the same file.
+ *
+ * @param entries Number of entries the named table has, a file with any other number is rejected
+ * @param verify Also check the checksum, which reads the whole file
+ * @return true if the file held a valid table with the given name and size
+ */
+bool PatternDatabase::load(const std::string &path, const std::string &name, uint64_t entries, PatternDatabase &database, bool verify)
+{
+    PatternDatabaseHeader header;
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+    uint64_t fileSize = file.tellg();
+    file.seekg(0);
+
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) || header.magic != PATTERN_DATABASE_MAGIC)
+    {
+        std::cout << path << " is not a pattern database" << std::endl;
+        return false;
+    }
+    header.name[sizeof(header.name) - 1] = 0;
+    if (header.version != FILE_VERSION || name != header.name || header.entries != entries || (header.bitsPerEntry != 4 && header.bitsPerEntry != 2)
+        || header.dataSize != tableBytes(header.entries, header.bitsPerEntry) || fileSize != sizeof(header) + header.dataSize)
+    {
+        std::cout << path << " does not hold version " << FILE_VERSION << " of pattern database " << name << " with " << entries << " entries" << std::endl;
+        return false;
+    }
+
+    PatternDatabase loaded;
+    loaded.entries = header.entries;
+    loaded.bits = header.bitsPerEntry;
+
+#if RUBIX_MMAP
+    file.close();
+    int descriptor = open(path.c_str(), O_RDONLY);
+    void *mapping = descriptor < 0 ? MAP_FAILED : mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, descriptor, 0);
+    if (descriptor >= 0)
+        close(descriptor);
+    if (mapping == MAP_FAILED)
+    {
+        std::cout << "Failed to map pattern database " << path << std::endl;
+        return false;
+    }
+    // Lookups jump all over the table, so reading ahead of them only wastes memory
+    madvise(mapping, fileSize, MADV_RANDOM);
+
+    loaded.mapping = mapping;
+    loaded.mappingSize = fileSize;
+    loaded.table = static_cast<const uint8_t *>(mapping) + sizeof(header);
+#else
+    loaded.data.resize(header.dataSize);
+    if (!file.read(reinterpret_cast<char *>(loaded.data.data()), header.dataSize))
+    {
+        std::cout << "Failed to read pattern database " << path << std::endl;
+        return false;
+    }
+    loaded.table = loaded.data.data();
+#endif
+
+    if (verify && loaded.checksum() != header.checksum)
+    {
+        std::cout << path << " is corrupted, the checksum does not match" << std::endl;
+        return false;
+    }
+
+    database = std::move(loaded);
+    return true;
+}
+
+// #######################
+// Database Indices
+// #######################
+
+/**
+ * @brief Numbers an ordered choice of count distinct positions out of n so that every choice gets a unique index
+ * below n! / (n - count)!. Each position is counted among the positions not used by earlier pieces.
+ */
+static uint64_t rankPositions(const uint8_t *positions, int count, int n)
+{
+    uint64_t rank = 0;
+    std::bitset<12> used;
+
+    for (int i = 0; i < count; i++)
+    {
+        int smallerUsed = (used & std::bitset<12>((1u << positions[i]) - 1)).count();
+        rank = rank * (n - i) + positions[i] - smallerUsed;
+        used.set(positions[i]);
+    }
+
+    return rank;
+}
+
+static void unrankPositions(uint64_t rank, uint8_t *positions, int count, int n)
+{
+    int digits[12];
+    for (int i = count - 1; i >= 0; i--)
+    {
+        digits[i] = rank % (n - i);
+        rank /= n - i;
+    }
+
+    std::bitset<12> used;
+    for (int i = 0; i < count; i++)
+    {
+        int position = 0;
+        for (int unused = digits[i]; used[position] || unused > 0; position++)
+        {
+            if (!used[position])
+                unused--;
+        }
+        used.set(position);
+        positions[i] = position;
+    }
+}
+
+uint64_t cornerIndex(const PieceState &state)
+{
+    uint8_t positions[8];
+    uint64_t twist = 0;
+
+    for (int i = 0; i < 8; i++)
+        positions[i] = state.corners[i] / 3;
+    // The twist of the last corner is fixed by the other seven
+    for (int i = 0; i < 7; i++)
+        twist = twist * 3 + state.corners[i] % 3;
+
+    return rankPositions(positions, 8, 8) * 2187 + twist;
+}
+
+static void setCornerIndex(PieceState &state, uint64_t index)
+{
+    uint8_t positions[8];
+    uint64_t twist = index % 2187;
+    int total = 0;
+
+    unrankPositions(index / 2187, positions, 8, 8);
+    for (int i = 6; i >= 0; i--)
+    {
+        state.corners[i] = positions[i] * 3 + twist % 3;
+        total += twist % 3;
+        twist /= 3;
+    }
+    state.corners[7] = positions[7] * 3 + (3 - total % 3) % 3;
+}
+
+uint64_t edgeIndex(const PieceState &state, int firstEdge)
+{
+    uint8_t positions[6];
+    uint64_t flip = 0;
+
+    for (int i = 0; i < 6; i++)
+    {
+        positions[i] = state.edges[firstEdge + i] / 2;
+        flip = flip * 2 + state.edges[firstEdge + i] % 2;
+    }
+
+    return rankPositions(positions, 6, 12) * 64 + flip;
+}
+
+static void setEdgeIndex(PieceState &state, uint64_t index, int firstEdge)
+{
+    uint8_t positions[6];
+
+    unrankPositions(index / 64, positions, 6, 12);
+    for (int i = 5; i >= 0; i--)
+    {
+        state.edges[firstEdge + i] = positions[i] * 2 + (index & 1);
+        index >>= 1;
+    }
+}
+
+// #######################
+// Database Generation
+// #######################
+
+// Entries are read and written from several threads at once while a database is generated. Setting an entry
+// only clears bits of an unreached (all ones) entry and every thread sets the same distance during a pass,
+// so an atomic and is enough to set an entry without losing its neighbour in the same byte.
+static uint8_t loadDistance(const uint8_t *data, uint64_t index)
+{
+    return (__atomic_load_n(&data[index >> 1], __ATOMIC_RELAXED) >> ((index & 1) * 4)) & 15;
+}
+
+static bool claimDistance(uint8_t *data, uint64_t index, uint8_t distance)
+{
+    int shift = (index & 1) * 4;
+    uint8_t previous = __atomic_fetch_and(&data[index >> 1], static_cast<uint8_t>(~(15 << shift) | distance << shift), __ATOMIC_RELAXED);
+    return ((previous >> shift) & 15) == PatternDatabase::UNKNOWN;
+}
+
+/**
+ * @brief Breadth first search out from the solved cube, one depth at a time. While few entries have
+ * been reached every entry at the current depth is expanded by all 18 moves. Once most have been reached
+ * it is cheaper to go backwards and check each unreached entry for a neighbour at the current depth.
+ * Each pass is split into blocks of entries that the threads take in turn.
+ */
+template <typename SetIndex, typename GetIndex>
+static PatternDatabase buildDatabase(uint64_t size, int threads, SetIndex setIndex, GetIndex getIndex)
+{
+    const uint64_t BLOCK_SIZE = 1 << 16;
+    std::vector<uint8_t> data((size + 1) / 2, 0xFF);
+    uint64_t filled = 1;
+    uint64_t frontier = 1;
+    claimDistance(data.data(), getIndex(PieceState()), 0);
+
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (uint8_t depth = 0; filled < size; depth++)
+    {
+        bool backwards = frontier > size - filled;
+        std::atomic<uint64_t> nextBlock(0);
+        std::atomic<uint64_t> reached(0);
+
+        auto searchBlocks = [&]()
+        {
+            uint64_t found = 0;
+            for (uint64_t start = nextBlock++ * BLOCK_SIZE; start < size; start = nextBlock++ * BLOCK_SIZE)
+            {
+                for (uint64_t index = start; index < std::min(start + BLOCK_SIZE, size); index++)
+                {
+                    uint8_t distance = loadDistance(data.data(), index);
+                    if (backwards ? distance != PatternDatabase::UNKNOWN : distance != depth)
+                        continue;
+
+                    PieceState state;
+                    setIndex(state, index);
+
+                    for (int move = 0; move < 18; move++)
+                    {
+                        PieceState next = state;
+                        uint64_t nextIndex = getIndex(next.applyMove(move));
+
+                        if (backwards && loadDistance(data.data(), nextIndex) == depth)
+                        {
+                            claimDistance(data.data(), index, depth + 1);
+                            found++;
+                            break;
+                        }
+                        else if (!backwards && loadDistance(data.data(), nextIndex) == PatternDatabase::UNKNOWN
+                            && claimDistance(data.data(), nextIndex, depth + 1))
+                        {
+                            found++;
+                        }
+                    }
+                }
+            }
+            reached += found;
+        };
+
+        std::vector<std::thread> workers;
+        for (int i = 1; i < threads; i++)
+            workers.emplace_back(searchBlocks);
+        searchBlocks();
+        for (std::thread &worker : workers)
+            worker.join();
+
+        frontier = reached;
+        filled += frontier;
+    }
+
+    return PatternDatabase(size, std::move(data));
+}
+
+PatternDatabase buildCornerDatabase(int threads)
+{
+    return buildDatabase(CORNER_DATABASE_SIZE, threads, setCornerIndex, cornerIndex);
+}
+
+PatternDatabase buildEdgeDatabase(int firstEdge, int threads)
+{
+    return buildDatabase(EDGE_DATABASE_SIZE, threads,
+        [firstEdge](PieceState &state, uint64_t index) { setEdgeIndex(state, index, firstEdge); },
+        [firstEdge](const PieceState &state) { return edgeIndex(state, firstEdge); });
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "cubieCube.hpp"
+#include <vector>
+#include <string>
+
+// Where every piece is, indexed by piece instead of by position since pattern database indices
+// follow a subset of the pieces. Corners hold position * 3 + twist and edges position * 2 + flip.
+struct PieceState
+{
+    PieceState();
+    PieceState(const CubieCube &cube);
+
+    PieceState & applyMove(int move);
+
+    uint8_t corners[8];
+    uint8_t edges[12];
+};
+
+// Table of the fewest moves needed to solve a subset of the pieces from every arrangement of them.
+// Tables built in memory hold the distances 4 bits per entry, with 15 for an entry that has not been reached.
+// Tables saved with 2 bits per entry only hold the distance mod 3, which is enough to get the exact
+// distance of a state from the distance of a neighbour since neighbours are at most one move apart.
+// Loaded tables are memory mapped read only, so processes using the same file share one copy in memory.
+class PatternDatabase
+{
+    public:
+    PatternDatabase();
+    PatternDatabase(uint64_t _entries, std::vector<uint8_t> &&_data);
+    PatternDatabase(PatternDatabase &&other);
+    PatternDatabase & operator=(PatternDatabase &&other);
+    PatternDatabase(const PatternDatabase &) = delete;
+    PatternDatabase & operator=(const PatternDatabase &) = delete;
+    ~PatternDatabase();
+
+    // The value stored for an entry, the distance for 4 bit tables and the distance mod 3 for 2 bit tables
+    uint8_t entry(uint64_t index) const
+    {
+        return bits == 4 ? (table[index >> 1] >> ((index & 1) * 4)) & 15 : (table[index >> 2] >> ((index & 3) * 2)) & 3;
+    }
+    // Distance of an entry, only for 4 bit tables
+    uint8_t distance(uint64_t index) const { return entry(index); }
+    // Distance of an entry one move away from an entry at neighbourDistance
+    uint8_t distance(uint64_t index, uint8_t neighbourDistance) const;
+
+    uint64_t size() const { return entries; }
+    int bitsPerEntry() const { return bits; }
+    uint64_t checksum() const;
+
+    bool save(const std::string &path, const std::string &name, int bitsPerEntry = 4) const;
+    // Only accepts a file holding the named table with exactly entries entries, so lookups stay inside it
+    static bool load(const std::string &path, const std::string &name, uint64_t entries, PatternDatabase &database, bool verify = false);
+
+    static const uint8_t UNKNOWN = 15;
+    static const uint32_t FILE_VERSION = 1;
+
+    private:
+    void release();
+
+    uint64_t entries;
+    int bits;
+    std::vector<uint8_t> data; // Entries of a table built or read into memory
+    const uint8_t *table; // Entries of the table, either in data or in the mapped file
+    void *mapping;
+    size_t mappingSize;
+};
+
+// Korf's pattern databases: all corners, and two sets of six edges (UR to DF and DL to BR)
+static const uint64_t CORNER_DATABASE_SIZE = 88179840; // 8! * 3^7
+static const uint64_t EDGE_DATABASE_SIZE = 42577920; // 12! / 6! * 2^6
+
+uint64_t cornerIndex(const PieceState &state);
+uint64_t edgeIndex(const PieceState &state, int firstEdge);
+
+// The generators search all threads (0 for one per core) in parallel
+PatternDatabase buildCornerDatabase(int threads = 0);
+PatternDatabase buildEdgeDatabase(int firstEdge, int threads = 0);
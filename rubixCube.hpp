@@ -1,7 +1,16 @@
+#pragma once
 #include <vector>
+#include <array>
+#include <tuple>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <stdexcept>
+#include <cstring>
+#include <functional>
 
 // RubixColor and RubixFace are ordered to match color to face.
-enum RubixColor
+enum RubixColor : uint8_t
 {
     WHITE,
     YELLOW,
@@ -21,68 +30,308 @@ enum RubixFace
     BACK
 };
 
+enum RubixTurn
+{
+    CLOCKWISE,
+    HALF_TURN,
+    COUNTER_CLOCKWISE
+};
+
+// A move in one byte, numbered face * 3 + turn like the moves of RubixCube::applyMove
+struct Move
+{
+    Move() = default;
+    explicit constexpr Move(uint8_t _value) : value(_value) {}
+    constexpr Move(RubixFace face, RubixTurn turn) : value(face * 3 + turn) {}
+
+    RubixFace face() const { return static_cast<RubixFace>(value / 3); }
+    RubixTurn turn() const { return static_cast<RubixTurn>(value % 3); }
+    // Number of CW quarter turns, 1 to 3
+    int quarterTurns() const { return value % 3 + 1; }
+    Move inverse() const { return Move(face(), static_cast<RubixTurn>(2 - turn())); }
+
+    bool operator==(Move other) const { return value == other.value; }
+    bool operator!=(Move other) const { return value != other.value; }
+
+    uint8_t value;
+};
+
+// Instruction sets the move kernel can use, from slowest to fastest.
+// Every kernel gives bit identical results.
+enum MoveKernel
+{
+    SCALAR_KERNEL,
+    SSSE3_KERNEL,
+    AVX2_KERNEL,
+    AVX512_KERNEL
+};
+
+// Result of reading a facelet string, anything other than FACELETS_VALID says why it was rejected
+enum FaceletStatus
+{
+    FACELETS_VALID,
+    FACELETS_WRONG_LENGTH, // Not exactly 54 characters
+    FACELETS_BAD_LETTER, // A character that is not one of U, R, F, D, L or B
+    FACELETS_WRONG_COUNT, // A letter that is not used exactly 9 times
+    FACELETS_WRONG_CENTER // A center that does not have the letter of its face
+};
+
+const char * faceletStatusText(FaceletStatus status);
+
+// View of the 3x3 stickers of one face. The stickers themselves are owned by the RubixCube
+// the face was queried from, so a Face is only valid as long as that cube is.
+// Stickers only change through RubixCube, a Face can only read them.
 class Face
 {
     friend class RubixCube;
     public:
-    Face(RubixColor c);
-
-    RubixColor sticker(int row, int column) const;
-    Face & rotateCW();
-    Face & rotateCCW();
+    RubixColor sticker(int row, int column) const { return stickers[row * 3 + column]; }
 
     bool operator==(const Face &other);
     unsigned equivalence(const Face &other);
-    void reset();
 
     private:
-    std::vector<std::vector<RubixColor> > stickers; // 3x3 matrix holding color locations on the face
+    Face(RubixColor *_stickers) : stickers(_stickers) {}
+    Face & rotateCW();
+    Face & rotateCCW();
+    void reset();
+    RubixColor & at(int row, int column) { return stickers[row * 3 + column]; }
+
+    RubixColor *stickers; // 3x3 matrix holding color locations on the face, stored row by row
 };
 
 // Rubix cube Class for containing the color locations and manipulating the cube
-class RubixCube
+// All 54 stickers live in one cache line so copying a cube is a single 64 byte copy.
+class alignas(64) RubixCube
 {
+    friend class CubieCube;
     public:
     RubixCube();
     RubixCube(int moves);
+    RubixCube(int moves, std::mt19937 &random);
+    // Throws std::invalid_argument if the facelet string is rejected
+    explicit RubixCube(const std::string &facelets);
+
+    // Facelet strings list the 9 stickers of each face in the order U, R, F, D, L, B, each sticker as the
+    // letter of the face whose center has its color. Every face is read row by row with U and D seen with
+    // B and F at the top and the side faces seen with U at the top, which is also how stickers are stored here.
+    // On anything other than FACELETS_VALID the cube is left unchanged.
+    static FaceletStatus fromFacelets(const char *facelets, size_t length, RubixCube &cube);
+    // Writes the 54 letters without a terminating zero
+    void toFacelets(char *facelets) const;
+    std::string toFacelets() const;
 
     void print(int spacing = 0);
-    bool equivalent(RubixCube &other);
+    bool equivalent(const RubixCube &other) const { return std::memcmp(stickers, other.stickers, sizeof(stickers)) == 0; }
+    bool operator==(const RubixCube &other) const { return equivalent(other); }
+    bool operator!=(const RubixCube &other) const { return !equivalent(other); }
     unsigned equivalence(RubixCube &other);
-    RubixCube & reset() { up.reset(); down.reset(); front.reset(); back.reset(); left.reset(); right.reset(); return *this; };
 
-    RubixCube & rotateCW(RubixFace face);
-    RubixCube & rotateCCW(RubixFace face);
+    // Zobrist hash of the stickers, worked out when asked for so moves don't pay for it
+    uint64_t hash() const;
+    RubixCube & reset();
+
+    // Moves are numbered face * 3 + turn where turn is CW, half, CCW
+    RubixCube & rotateCW(RubixFace face) { return applyMove(face * 3); }
+    RubixCube & rotateCCW(RubixFace face) { return applyMove(face * 3 + 2); }
+    RubixCube & rotateHalf(RubixFace face) { return applyMove(face * 3 + 1); }
+    RubixCube & applyMove(int move) { permuteKernel(stickers, move); return *this; }
+    RubixCube & applyMove(Move move) { return applyMove(move.value); }
+
+    Face queryFace(RubixFace face) { return Face(&stickers[face * 9]); }
 
-    Face & queryFace(RubixFace face);
+    // The 24 rotations of the whole cube and their mirror images. Symmetry 0 leaves the cube as it is.
+    static const int SYMMETRIES = 48;
+    // The cube turned or mirrored as a whole with its stickers recolored so the centers keep their colors,
+    // which is the same scramble seen from another side
+    RubixCube symmetric(int symmetry) const;
+    // The smallest of the 48 symmetric cubes, which is the same for every cube in a symmetry class.
+    // symmetry is set to the symmetry that turns this cube into it.
+    RubixCube canonical(int *symmetry = nullptr) const;
+    static int inverseSymmetry(int symmetry);
+    // The move that does to symmetric(symmetry) what move does to this cube
+    static Move symmetricMove(Move move, int symmetry);
+
+    // The fastest kernel the CPU supports is picked at startup, these allow overriding it
+    static MoveKernel moveKernel();
+    static bool useMoveKernel(MoveKernel kernel);
 
     private:
-    Face up;
-    Face down;
-    Face front;
-    Face back;
-    Face left;
-    Face right;
+    static void (*permuteKernel)(RubixColor *stickers, int move);
+
+    // 9 stickers per face in RubixFace order. The last 10 bytes are padding and always zero.
+    RubixColor stickers[64];
 };
 
+namespace std
+{
+    template <>
+    struct hash<RubixCube>
+    {
+        size_t operator()(const RubixCube &cube) const { return cube.hash(); }
+    };
+}
+
 using Edge = std::pair<RubixFace,RubixFace>;
-using Corner = std::vector<RubixFace>;
+using Corner = std::array<RubixFace, 3>;
 using MoveSet = std::vector<std::tuple<RubixFace, int, const char *> >;
 
+// Adds a move numbered face * 3 + turn to the end of a MoveSet, half turns become two CW turns
+void appendMove(MoveSet &moveSet, int move);
+
+// Sequence of one byte moves. Up to INLINE_CAPACITY moves are stored inside the sequence itself,
+// longer sequences move to the heap, so a whole sequence object is one cache line.
+class MoveSequence
+{
+    public:
+    static const uint32_t INLINE_CAPACITY = 48;
+
+    MoveSequence() : moves(inlineMoves), length(0), capacity(INLINE_CAPACITY) {}
+    explicit MoveSequence(const MoveSet &moveSet);
+    MoveSequence(const MoveSequence &other);
+    MoveSequence(MoveSequence &&other) noexcept;
+    MoveSequence & operator=(const MoveSequence &other);
+    MoveSequence & operator=(MoveSequence &&other) noexcept;
+    ~MoveSequence();
+
+    void push_back(Move move)
+    {
+        if (length == capacity)
+            reserve(capacity * 2);
+        moves[length++] = move;
+    }
+    void pop_back() { length--; }
+    void clear() { length = 0; }
+    void reserve(uint32_t _capacity);
+
+    uint32_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    Move & operator[](uint32_t i) { return moves[i]; }
+    Move operator[](uint32_t i) const { return moves[i]; }
+    const Move * begin() const { return moves; }
+    const Move * end() const { return moves + length; }
+    bool operator==(const MoveSequence &other) const;
+
+    // Half turns become two CW turns like every other MoveSet
+    MoveSet toMoveSet() const;
+
+    private:
+    Move *moves; // inlineMoves or a heap array of capacity moves
+    uint32_t length;
+    uint32_t capacity;
+    Move inlineMoves[INLINE_CAPACITY];
+};
+
+// Every move of a sequence changed by a symmetry. A solution of cube.symmetric(symmetry) becomes a solution of
+// cube with RubixCube::inverseSymmetry(symmetry).
+MoveSequence symmetricMoves(const MoveSequence &moves, int symmetry);
+
+// Shortens a move sequence without changing what it does to a cube by cancelling and merging turns of the same face
+MoveSequence optimizeMoves(const MoveSequence &moves);
+MoveSet optimizeMoves(const MoveSet &moveSet);
+
+// Stages of RubixCubeSolver in the order they are solved
+enum SolverStage
+{
+    NO_STAGE,
+    CROSS_STAGE,
+    TOP_CORNERS_STAGE,
+    MIDDLE_LAYER_STAGE,
+    BOTTOM_CROSS_STAGE,
+    BOTTOM_FACE_STAGE,
+    THIRD_LAYER_STAGE,
+    LAST_LAYER_STAGE // Replaces the bottom cross, bottom face and third layer stages when solving a whole cube
+};
+
+const char * solverStageName(SolverStage stage);
+
+// Thrown by RubixCubeSolver when the cube ends up in a state its algorithms don't handle, which only happens for invalid cubes,
+// or when a stage runs over its SolverBudget. Errors thrown while solving say which stage failed and what the cube looked like.
+class SolverError : public std::runtime_error
+{
+    public:
+    SolverError(const std::string &message) : std::runtime_error(message) {}
+    SolverError(const std::string &message, SolverStage _stage, bool _budgetExceeded, const std::string &_facelets)
+    : std::runtime_error(message), stage(_stage), budgetExceeded(_budgetExceeded), facelets(_facelets) {}
+
+    SolverStage stage = NO_STAGE;
+    bool budgetExceeded = false;
+    std::string facelets; // The cube when the stage failed as a facelet string, empty outside of a stage
+};
+
+// Limits on the work of each RubixCubeSolver stage, which bound how long any solve can take.
+// The defaults are about four times the most any stage needed over 200000 random cubes (41 iterations and 116 moves).
+struct SolverBudget
+{
+    int iterations = 160; // Passes through the loops of one stage
+    int moves = 480; // Quarter turns made by one stage
+};
+
+// Hook for following a RubixCubeSolver as it works, the solver itself never prints anything.
+// Every function does nothing by default so observers only override what they need.
+class SolverObserver
+{
+    public:
+    virtual ~SolverObserver() = default;
+
+    // Called before the first move of a cube that is not already solved
+    virtual void solveStarted(const RubixCube & /*cube*/) {}
+    // Called before each turn with the cube as it is before the turn
+    virtual void rotating(const RubixCube & /*cube*/, RubixFace /*face*/, bool /*clockwise*/) {}
+    virtual void solveFinished(const RubixCube & /*cube*/, int /*moves*/, double /*seconds*/) {}
+};
+
+// Solutions of a batch of cubes stored back to back in one buffer. The moves of cube i
+// are moves[offsets[i]] up to moves[offsets[i + 1]]. Cubes that could not be solved have no moves and are listed in failures.
+struct BatchSolution
+{
+    std::vector<Move> moves;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> failures;
+
+    size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    const Move * solution(size_t cube) const { return moves.data() + offsets[cube]; }
+    uint32_t solutionLength(size_t cube) const { return offsets[cube + 1] - offsets[cube]; }
+};
+
+class SolutionCache;
+class EndgameTable;
+
 class RubixCubeSolver
 {
     public:
     RubixCubeSolver();
+
+    // Solves count cubes on threads threads (0 for one per core), each with its own solver
+    static BatchSolution solveBatch(const RubixCube *cubes, size_t count, int threads = 0, SolutionCache *cache = nullptr, const EndgameTable *endgame = nullptr);
+
+    // The observer is not owned by the solver and must outlive it, nullptr to stop observing
+    void setObserver(SolverObserver *_observer) { observer = _observer; }
+    void setBudget(const SolverBudget &_budget) { budget = _budget; }
+    // Solutions are looked up in the cache before solving and added to it after. Solves answered by the cache
+    // report no rotations to the observer. The cache is not owned and may be shared with other solvers.
+    void setCache(SolutionCache *_cache) { cache = _cache; }
+    // Cubes in the table get its optimal solutions instead of a layer by layer solve. It is tried before the cache
+    // and its solutions are not cached. Like cached solves, these report no rotations to the observer.
+    // The table is not owned and may be shared with other solvers.
+    void setEndgameTable(const EndgameTable *_endgame) { endgame = _endgame; }
     
-    MoveSet solveCube(RubixCube & _mixedCube);
+    const MoveSet & solveCube(RubixCube & _mixedCube);
+    RubixCubeSolver & reset();
+    // The last solution as one byte moves
+    const MoveSequence & moveSequence() const { return sequence; }
 
     //Functions for solving subsections of the cube
     void solveCross();
+    // Solves the cross in the fewest moves possible, at most 8, by following a table of distances
+    void solveOptimalCross();
     void solveTopCorners();
     void solveMiddleLayer();
     void solveBottomCross();
     void solveBottomFace();
     void solveThirdLayer();
+    // Solves the whole bottom layer at once with the stored algorithm for its case
+    void solveLastLayer();
 
     // Algoriths for manipulating specific pieces
     void topCornerTopUp(RubixFace face, bool reverse=false);
@@ -121,9 +370,27 @@ class RubixCubeSolver
     RubixCubeSolver & rotateCW(RubixFace face);
     RubixCubeSolver & rotateCCW(RubixFace face);
 
+    void beginStage(SolverStage _stage);
+    // Counts one pass through a loop of the current stage
+    void nextIteration()
+    {
+        if (++stageIterations > budget.iterations)
+            budgetExceeded("iterations");
+    }
+    [[noreturn]] void budgetExceeded(const char *limit);
+
     private:
     int moves = 0;
     MoveSet moveSet;
+    MoveSequence sequence;
+    SolverObserver *observer = nullptr;
+    SolutionCache *cache = nullptr;
+    const EndgameTable *endgame = nullptr;
+
+    SolverBudget budget;
+    SolverStage stage = NO_STAGE;
+    int stageIterations = 0;
+    int stageMoveLimit = 0; // Value of moves at which the current stage runs out of moves
 
     RubixCube solvedCube;
     RubixCube mixedCube;
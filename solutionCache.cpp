@@ -0,0 +1,188 @@
+#include "solutionCache.hpp"
+#include "notation.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+SolutionCache::SolutionCache(size_t _capacity)
+: shardCapacity(std::max<size_t>(1, (_capacity + SHARDS - 1) / SHARDS)), hitCount(0), missCount(0), evictionCount(0)
+{}
+
+/**
+ * @brief Looks up the canonical cube of cube and turns its solution back with the inverse symmetry.
+ */
+bool SolutionCache::find(const RubixCube &cube, MoveSequence &solution)
+{
+    int symmetry;
+    RubixCube canonical = cube.canonical(&symmetry);
+    uint64_t hash = canonical.hash();
+    Shard &shard = shardOf(hash);
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto slot = shard.slots.find(hash);
+        if (slot != shard.slots.end() && shard.entries[slot->second].cube.equivalent(canonical))
+        {
+            Entry &entry = shard.entries[slot->second];
+            entry.referenced = true;
+
+            Move moves[18];
+            for (int move = 0; move < 18; move++)
+                moves[move] = RubixCube::symmetricMove(Move(move), RubixCube::inverseSymmetry(symmetry));
+            solution.clear();
+            solution.reserve(entry.length);
+            for (uint32_t i = 0; i < entry.length; i++)
+                solution.push_back(moves[entry.moves[i].value]);
+            hitCount++;
+            return true;
+        }
+    }
+
+    missCount++;
+    return false;
+}
+
+void SolutionCache::insert(const RubixCube &cube, const MoveSequence &solution)
+{
+    int symmetry;
+    RubixCube canonical = cube.canonical(&symmetry);
+    MoveSequence canonicalSolution = symmetricMoves(solution, symmetry);
+    insertCanonical(canonical, canonicalSolution.begin(), canonicalSolution.size());
+}
+
+/**
+ * @brief Stores a solution in the shard of the cube. A cube that is already cached, or that has the same hash
+ * as a cached cube, replaces its entry. Otherwise a full shard moves its clock hand to the first entry
+ * that has not been used since the hand last passed it and replaces that.
+ */
+void SolutionCache::insertCanonical(const RubixCube &cube, const Move *moves, uint32_t length)
+{
+    std::unique_ptr<Move[]> copy(new Move[length ? length : 1]);
+    std::copy(moves, moves + length, copy.get());
+
+    uint64_t hash = cube.hash();
+    Shard &shard = shardOf(hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    uint32_t slot;
+    auto found = shard.slots.find(hash);
+    if (found != shard.slots.end())
+        slot = found->second;
+    else if (shard.entries.size() < shardCapacity)
+    {
+        slot = shard.entries.size();
+        shard.entries.emplace_back();
+        shard.slots[hash] = slot;
+    }
+    else
+    {
+        while (shard.entries[shard.hand].referenced)
+        {
+            shard.entries[shard.hand].referenced = false;
+            shard.hand = (shard.hand + 1) % shard.entries.size();
+        }
+        slot = shard.hand;
+        shard.hand = (shard.hand + 1) % shard.entries.size();
+        shard.slots.erase(shard.entries[slot].cube.hash());
+        shard.slots[hash] = slot;
+        evictionCount++;
+    }
+
+    Entry &entry = shard.entries[slot];
+    entry.cube = cube;
+    entry.moves = std::move(copy);
+    entry.length = length;
+    entry.referenced = false;
+}
+
+void SolutionCache::clear()
+{
+    for (Shard &shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.slots.clear();
+        shard.entries.clear();
+        shard.hand = 0;
+    }
+    hitCount = 0;
+    missCount = 0;
+    evictionCount = 0;
+}
+
+size_t SolutionCache::size() const
+{
+    size_t total = 0;
+    for (const Shard &shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.entries.size();
+    }
+    return total;
+}
+
+/**
+ * @brief Writes every cached cube as its facelet string followed by its solution in Singmaster notation.
+ * The file is written next to path and renamed over it, so a failed save leaves the old file in place.
+ */
+bool SolutionCache::save(const std::string &path) const
+{
+    std::string temporaryPath = path + ".tmp";
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    std::string line;
+
+    for (const Shard &shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const Entry &entry : shard.entries)
+        {
+            line.resize(55 + entry.length * MAX_MOVE_NOTATION + 1);
+            entry.cube.toFacelets(&line[0]);
+            line[54] = ' ';
+            size_t length = 55 + formatNotation(entry.moves.get(), entry.length, &line[55], line.size() - 55);
+            line[length] = '\n';
+            file.write(line.data(), length + 1);
+        }
+    }
+    file.close();
+
+    if (!file || std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        std::cout << "Failed to write solution cache " << path << std::endl;
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool SolutionCache::load(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    std::string line;
+    MoveSequence solution;
+    while (std::getline(file, line))
+    {
+        RubixCube cube;
+        if (line.size() < 55 || line[54] != ' ' || RubixCube::fromFacelets(line.data(), 54, cube) != FACELETS_VALID)
+            continue;
+
+        solution.clear();
+        if (!parseNotation(line.data() + 55, line.data() + line.size(), solution).valid)
+            continue;
+
+        // Only keep solutions that solve their cube, and only canonical cubes since nothing else is ever looked up
+        RubixCube solved = cube;
+        for (Move move : solution)
+            solved.applyMove(move);
+        if (solved != RubixCube() || !cube.canonical().equivalent(cube))
+            continue;
+
+        insertCanonical(cube, solution.begin(), solution.size());
+    }
+
+    return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include "rubixCube.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Bounded cache of solutions shared by any number of threads. Cubes are stored as the canonical cube of their
+// symmetry class, so a cube also hits on the solutions of its 47 rotated and mirrored versions, and are looked up
+// by their Zobrist hash. The cache is split into shards with a lock each, and every shard evicts with the CLOCK
+// algorithm: a hit marks an entry, and the clock hand clears marks until it finds an unmarked entry to replace.
+// Solutions can be saved to a text file and loaded into a later process, one "facelets moves" line per cube.
+class SolutionCache
+{
+    public:
+    static const size_t SHARDS = 16;
+
+    // Capacity is rounded up to a multiple of SHARDS
+    explicit SolutionCache(size_t _capacity = 1 << 16);
+    SolutionCache(const SolutionCache &) = delete;
+    SolutionCache & operator=(const SolutionCache &) = delete;
+
+    // Sets solution to the cached solution of cube, false if there is none
+    bool find(const RubixCube &cube, MoveSequence &solution);
+    void insert(const RubixCube &cube, const MoveSequence &solution);
+    void clear();
+
+    size_t size() const;
+    size_t capacity() const { return shardCapacity * SHARDS; }
+    uint64_t hits() const { return hitCount; }
+    uint64_t misses() const { return missCount; }
+    uint64_t evictions() const { return evictionCount; }
+
+    bool save(const std::string &path) const;
+    // Adds the solutions in a file written by save. Lines that don't solve their cube are skipped.
+    // Returns false if the file can't be read.
+    bool load(const std::string &path);
+
+    private:
+    struct Entry
+    {
+        RubixCube cube; // Canonical cube
+        std::unique_ptr<Move[]> moves; // Solution of the canonical cube
+        uint32_t length;
+        bool referenced;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<uint64_t, uint32_t> slots; // Entry of each hash
+        std::vector<Entry> entries;
+        size_t hand = 0;
+    };
+
+    Shard & shardOf(uint64_t hash) { return shards[hash % SHARDS]; }
+    void insertCanonical(const RubixCube &cube, const Move *moves, uint32_t length);
+
+    size_t shardCapacity;
+    Shard shards[SHARDS];
+    std::atomic<uint64_t> hitCount;
+    std::atomic<uint64_t> missCount;
+    std::atomic<uint64_t> evictionCount;
+};